@@ -46,6 +46,7 @@
 #define _BUTTON_H
 
 // Include ********************************************************************
+#include <stdbool.h>
 #include "stm32f1xx_hal.h"
 
 // Exported defines ***********************************************************
@@ -57,6 +58,7 @@
 #define BUTTON_2_IRQ       EXTI4_IRQn
 #define BUTTON_GPIO        GPIOB
 #define BUTTON_GPIO_CLK    __HAL_RCC_GPIOB_CLK_ENABLE(); 
+#define BUTTON_IRQ_PRIORITY ( 5u )   // preemption priority of the debounce timer, it enqueues the button events
 
 // Exported types *************************************************************
 typedef enum
@@ -68,4 +70,6 @@ typedef enum
 
 // Exported functions *********************************************************
 Button_StatusTypeDef Button_init( void (*cbButton0Param)(void), void (*cbButton1Param)(void), void (*cbButton2Param)(void) );
+bool                 Button_isBusy( void );
+void                 Button_updateClock( void );
 #endif // _BUTTON_H
\ No newline at end of file
@@ -118,6 +118,31 @@ Button_StatusTypeDef Button_init( void (*cbButton0Param)(void), void (*cbButton1
    return buttonState;
 }
 
+// ----------------------------------------------------------------------------
+/// \brief     Checks if a button is being debounced.
+///
+/// \param     none
+///
+/// \return    bool, true while a button edge is debounced
+bool Button_isBusy( void )
+{
+   return button0DebouncePhase || button1DebouncePhase || button2DebouncePhase;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Derives the TIM1 prescaler again from SystemCoreClock after the
+///            system clock has been changed. The update event restarts the
+///            running millisecond, it doesn't count as a tick.
+///
+/// \param     none
+///
+/// \return    none
+void Button_updateClock( void )
+{
+   __HAL_TIM_SET_PRESCALER(&TIM1_Handle, (uint16_t) (SystemCoreClock / 10000) - 1);
+   TIM1->EGR = TIM_EGR_UG;
+}
+
 // ----------------------------------------------------------------------------
 /// \brief     Initialisation of the Timer.
 ///
@@ -146,9 +171,12 @@ static Button_StatusTypeDef init_timer( void )
    {
      return Button_ERROR;
    }
+   
+   // only overflows generate an interrupt, not the update event on a clock change
+   __HAL_TIM_URS_ENABLE(&TIM1_Handle);
 
    // configure TIM1 interrupt
-   HAL_NVIC_SetPriority(TIM1_UP_IRQn, 5, 5);
+   HAL_NVIC_SetPriority(TIM1_UP_IRQn, BUTTON_IRQ_PRIORITY, 5);
    HAL_NVIC_EnableIRQ(TIM1_UP_IRQn);
    
    // start the timer
@@ -0,0 +1,103 @@
+// ****************************************************************************
+/// \file      cycles.h
+///
+/// \brief     Cycles C HeaderFile
+///
+/// \details   Cycle statistics of the frame pipeline, measured with the
+///            Cortex-M3 DWT cycle counter.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+/// 
+/// \copyright Copyright (c) 2026 Nico Korn
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef _CYCLES_H
+#define _CYCLES_H
+
+// Include ********************************************************************
+#include "stm32f1xx_hal.h"
+
+// Exported defines ***********************************************************
+#define CYCLES_ENABLE          ( 0u )     // 1: the stages are measured, 0: the measurement macros compile to nothing
+
+#if( CYCLES_ENABLE == 1u )
+#define CYCLES_START(stage)           ( Cycles_Start[(stage)] = DWT->CYCCNT )
+#define CYCLES_STOP(stage)            Cycles_record( (stage), DWT->CYCCNT - Cycles_Start[(stage)] )
+#define CYCLES_RECORD(stage, cycles)  Cycles_record( (stage), (cycles) )
+#else
+#define CYCLES_START(stage)
+#define CYCLES_STOP(stage)
+#define CYCLES_RECORD(stage, cycles)
+#endif
+
+// Exported types *************************************************************
+typedef enum
+{
+   CYCLES_FRAME            = 0x00U,    // main loop iteration, event check and refresh
+   CYCLES_REFRESH          = 0x01U,    // refreshLeds
+   CYCLES_CLEAR            = 0x02U,    // WS2812B_clearBuffer
+   CYCLES_ENCODE           = 0x03U,    // encoding of the frame into the back buffer
+   CYCLES_TRANSFER         = 0x04U,    // dma transfer of the frame including the reset period
+   CYCLES_WAIT             = 0x05U,    // busy waiting on the driver state
+   CYCLES_PIXEL_SHIFTMASK  = 0x06U,    // WS2812B_test, one pixel column encoded stripe by stripe with shift and mask
+   CYCLES_PIXEL_BITBAND    = 0x07U,    // WS2812B_test, the same column through the bit-band alias
+   CYCLES_COLUMN_SHIFTMASK = 0x08U,    // WS2812B_test, one pixel column of all stripes with the shift and mask encoder
+   CYCLES_COLUMN_TRANSPOSE = 0x09U,    // WS2812B_test, the same column with the transpose encoder
+   CYCLES_STAGES           = 0x0AU
+} Cycles_StageTypeDef;
+
+typedef struct
+{
+   uint32_t    min;
+   uint32_t    max;
+   uint32_t    count;
+   uint32_t    last;
+   uint64_t    sum;              // average = sum / count
+} Cycles_StatTypeDef;
+
+// Exported variables *********************************************************
+#if( CYCLES_ENABLE == 1u )
+extern volatile uint32_t            Cycles_Start[CYCLES_STAGES];
+extern volatile Cycles_StatTypeDef  Cycles_Stats[CYCLES_STAGES];   // readable with the debugger
+#endif
+
+// Exported functions *********************************************************
+#if( CYCLES_ENABLE == 1u )
+void        Cycles_init       ( void );
+void        Cycles_reset      ( void );
+void        Cycles_record     ( Cycles_StageTypeDef stage, uint32_t cycles );
+uint32_t    Cycles_average    ( Cycles_StageTypeDef stage );
+#endif
+#endif // _CYCLES_H
\ No newline at end of file
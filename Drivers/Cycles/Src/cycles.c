@@ -0,0 +1,149 @@
+// ****************************************************************************
+/// \file      cycles.c
+///
+/// \brief     Cycles C Source File
+///
+/// \details   Cycle statistics of the frame pipeline, measured with the
+///            Cortex-M3 DWT cycle counter. A stage is measured between
+///            CYCLES_START and CYCLES_STOP, or recorded with an already
+///            measured count by CYCLES_RECORD. Min, max, count and sum of
+///            every stage are kept in Cycles_Stats.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+/// 
+/// \copyright Copyright (c) 2026 Nico Korn
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include "cycles.h"
+
+#if( CYCLES_ENABLE == 1u )
+// Private define *************************************************************
+
+// Private types     **********************************************************
+
+// Private variables **********************************************************
+
+// Private function prototypes ************************************************
+
+// Global variables ***********************************************************
+volatile uint32_t             Cycles_Start[CYCLES_STAGES];
+volatile Cycles_StatTypeDef   Cycles_Stats[CYCLES_STAGES];
+
+// Functions ******************************************************************
+// ----------------------------------------------------------------------------
+/// \brief     Enables the DWT cycle counter and clears the statistics.
+///
+/// \param     none
+///
+/// \return    none
+void Cycles_init( void )
+{
+   // enable the trace unit and the cycle counter
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+   
+   Cycles_reset();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Clears the statistics of all stages.
+///
+/// \param     none
+///
+/// \return    none
+void Cycles_reset( void )
+{
+   for( uint8_t stage = 0; stage < CYCLES_STAGES; stage++ )
+   {
+      __disable_irq();
+      Cycles_Stats[stage].min    = UINT32_MAX;
+      Cycles_Stats[stage].max    = 0u;
+      Cycles_Stats[stage].count  = 0u;
+      Cycles_Stats[stage].last   = 0u;
+      Cycles_Stats[stage].sum    = 0u;
+      __enable_irq();
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Adds a measurement to the statistics of a stage.
+///
+/// \param     [in] Cycles_StageTypeDef stage
+/// \param     [in] uint32_t cycles
+///
+/// \return    none
+void Cycles_record( Cycles_StageTypeDef stage, uint32_t cycles )
+{
+   volatile Cycles_StatTypeDef *stat = &Cycles_Stats[stage];
+   
+   if( cycles < stat->min )
+   {
+      stat->min = cycles;
+   }
+   
+   if( cycles > stat->max )
+   {
+      stat->max = cycles;
+   }
+   
+   stat->sum += cycles;
+   stat->count++;
+   stat->last = cycles;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Average cycles of a stage.
+///
+/// \param     [in] Cycles_StageTypeDef stage
+///
+/// \return    uint32_t cycles, 0 if the stage hasn't been measured yet
+uint32_t Cycles_average( Cycles_StageTypeDef stage )
+{
+   uint64_t sum;
+   uint32_t count;
+   
+   __disable_irq();
+   sum   = Cycles_Stats[stage].sum;
+   count = Cycles_Stats[stage].count;
+   __enable_irq();
+   
+   if( count == 0u )
+   {
+      return 0u;
+   }
+   
+   return (uint32_t)(sum/count);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+// ****************************************************************************
+/// \file      scheduler.h
+///
+/// \brief     Scheduler C HeaderFile
+///
+/// \details   Fixed timestep frame scheduler and monotonic millisecond
+///            clock, driven by TIM3.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+/// 
+/// \copyright Copyright (c) 2026 Nico Korn
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+// Include ********************************************************************
+#include "stm32f1xx_hal.h"
+
+// Exported defines ***********************************************************
+#define SCHEDULER_TIMER_HZ     ( 100000u )   // tim3 counter clock, 10 us resolution of the frame period
+#define SCHEDULER_FPS_MIN      ( 2u )        // the frame period must fit into the 16 bit auto reload register
+#define SCHEDULER_FPS_MAX      ( 1000u )
+
+// Exported types *************************************************************
+typedef enum
+{
+   Scheduler_OK       = 0x00U,
+   Scheduler_ERROR    = 0x01U,
+   Scheduler_OVERRUN  = 0x02U,
+   Scheduler_RESET    = 0x03U
+} Scheduler_StatusTypeDef;
+
+// Exported functions *********************************************************
+Scheduler_StatusTypeDef Scheduler_init          ( uint16_t fps );
+Scheduler_StatusTypeDef Scheduler_setFps        ( uint16_t fps );
+void                    Scheduler_updateClock   ( void );
+Scheduler_StatusTypeDef Scheduler_wait          ( void );
+void                    Scheduler_resync        ( void );
+uint32_t                Scheduler_getMs         ( void );
+uint32_t                Scheduler_getOverruns   ( void );
+#endif // _SCHEDULER_H
\ No newline at end of file
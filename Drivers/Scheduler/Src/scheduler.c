@@ -0,0 +1,316 @@
+// ****************************************************************************
+/// \file      scheduler.c
+///
+/// \brief     Scheduler C Source File
+///
+/// \details   Fixed timestep frame scheduler. TIM3 overflows once per frame
+///            period and Scheduler_wait releases the main loop on the next
+///            overflow, so the frame rate doesn't depend on the render and
+///            transfer time. A frame which takes longer than its period is
+///            counted as overrun and the schedule resyncs to the timer
+///            instead of catching up. The millisecond clock is accumulated
+///            from the timer ticks with integer math only and keeps running
+///            over frame rate changes.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+/// 
+/// \copyright Copyright (c) 2026 Nico Korn
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include "scheduler.h"
+
+// Private define *************************************************************
+#define TICKS_PER_MS           ( SCHEDULER_TIMER_HZ/1000u )
+
+#if( SCHEDULER_TIMER_HZ % 1000u != 0u )
+#error "SCHEDULER_TIMER_HZ must be a multiple of 1 kHz"
+#endif
+
+#if( SCHEDULER_TIMER_HZ/SCHEDULER_FPS_MIN > 0x10000u ) || ( SCHEDULER_TIMER_HZ/SCHEDULER_FPS_MAX < 2u )
+#error "the frame period doesn't fit into the 16 bit auto reload register"
+#endif
+
+// Private types     **********************************************************
+
+// Private variables **********************************************************
+static Scheduler_StatusTypeDef   schedulerState = Scheduler_RESET;
+static TIM_HandleTypeDef         TIM3_Handle;
+static uint32_t                  period;             // timer ticks per frame
+static volatile uint32_t         frameTick;          // frame periods elapsed, incremented by the timer
+static volatile uint32_t         msTick;             // milliseconds elapsed up to the last overflow
+static volatile uint32_t         msRemainder;        // timer ticks of the last overflows not yet counted in msTick
+static uint32_t                  frameCurrent;       // frame period the main loop is working in
+static uint32_t                  overruns;
+
+// Private function prototypes ************************************************
+static Scheduler_StatusTypeDef   init_timer          ( void );
+
+// Global variables ***********************************************************
+
+// Functions ******************************************************************
+// ----------------------------------------------------------------------------
+/// \brief     Initialisation of the frame scheduler.
+///
+/// \param     [in] uint16_t fps, SCHEDULER_FPS_MIN..SCHEDULER_FPS_MAX
+///
+/// \return    Scheduler_StatusTypeDef
+Scheduler_StatusTypeDef Scheduler_init( uint16_t fps )
+{
+   if( fps < SCHEDULER_FPS_MIN || fps > SCHEDULER_FPS_MAX )
+   {
+      schedulerState = Scheduler_ERROR;
+      return schedulerState;
+   }
+   
+   period         = SCHEDULER_TIMER_HZ/fps;
+   frameTick      = 0u;
+   msTick         = 0u;
+   msRemainder    = 0u;
+   frameCurrent   = 0u;
+   overruns       = 0u;
+   
+   if( init_timer() != Scheduler_OK )
+   {
+      schedulerState = Scheduler_ERROR;
+      return schedulerState;
+   }
+   
+   schedulerState = Scheduler_OK;
+   
+   return schedulerState;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Changes the frame rate. The running period is counted into the
+///            millisecond clock and the next period starts immediately.
+///
+/// \param     [in] uint16_t fps, SCHEDULER_FPS_MIN..SCHEDULER_FPS_MAX
+///
+/// \return    Scheduler_StatusTypeDef
+Scheduler_StatusTypeDef Scheduler_setFps( uint16_t fps )
+{
+   if( schedulerState != Scheduler_OK || fps < SCHEDULER_FPS_MIN || fps > SCHEDULER_FPS_MAX )
+   {
+      return Scheduler_ERROR;
+   }
+   
+   __disable_irq();
+   uint32_t remainder = msRemainder + __HAL_TIM_GET_COUNTER(&TIM3_Handle);
+   msTick         += remainder/TICKS_PER_MS;
+   msRemainder    = remainder%TICKS_PER_MS;
+   period         = SCHEDULER_TIMER_HZ/fps;
+   __HAL_TIM_SET_AUTORELOAD(&TIM3_Handle, period-1u);
+   __HAL_TIM_SET_COUNTER(&TIM3_Handle, 0u);
+   __HAL_TIM_CLEAR_IT(&TIM3_Handle, TIM_IT_UPDATE);
+   HAL_NVIC_ClearPendingIRQ(TIM3_IRQn);
+   __enable_irq();
+   
+   return Scheduler_OK;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Derives the TIM3 prescaler again from SystemCoreClock after the
+///            system clock has been changed. The ticks counted so far belong
+///            to the old clock and go into the millisecond clock, the running
+///            period starts over.
+///
+/// \param     none
+///
+/// \return    none
+void Scheduler_updateClock( void )
+{
+   __disable_irq();
+   uint32_t remainder = msRemainder + __HAL_TIM_GET_COUNTER(&TIM3_Handle);
+   msTick         += remainder/TICKS_PER_MS;
+   msRemainder    = remainder%TICKS_PER_MS;
+   __HAL_TIM_SET_PRESCALER(&TIM3_Handle, (uint16_t) (SystemCoreClock / SCHEDULER_TIMER_HZ) - 1);
+   TIM3->EGR = TIM_EGR_UG;
+   __enable_irq();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sleeps until the start of the next frame period. Returns at
+///            once if the period of the current frame has already elapsed.
+///
+/// \param     none
+///
+/// \return    Scheduler_StatusTypeDef, Scheduler_OVERRUN if the frame took
+///            longer than its period
+Scheduler_StatusTypeDef Scheduler_wait( void )
+{
+   if( frameTick != frameCurrent )
+   {
+      // the deadline has been missed, resync to the timer and drop the missed periods
+      overruns++;
+      frameCurrent = frameTick;
+      return Scheduler_OVERRUN;
+   }
+   
+   // sleep until the timer overflows, masked so the overflow can't slip in
+   // between the check and wfi, a pending interrupt wakes the core anyway
+   __disable_irq();
+   while( frameTick == frameCurrent )
+   {
+      __WFI();
+      __enable_irq();
+      __disable_irq();
+   }
+   __enable_irq();
+   
+   frameCurrent = frameTick;
+   
+   return Scheduler_OK;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Starts the current frame over at the running timer period, for
+///            a main loop which has slept somewhere else than in
+///            Scheduler_wait. The periods elapsed meanwhile aren't overruns.
+///
+/// \param     none
+///
+/// \return    none
+void Scheduler_resync( void )
+{
+   frameCurrent = frameTick;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Monotonic millisecond clock for animations, independent of the
+///            frame rate. Wraps after 49 days.
+///
+/// \param     none
+///
+/// \return    uint32_t ms since Scheduler_init
+uint32_t Scheduler_getMs( void )
+{
+   uint32_t ms;
+   uint32_t remainder;
+   
+   __disable_irq();
+   ms          = msTick;
+   remainder   = msRemainder + __HAL_TIM_GET_COUNTER(&TIM3_Handle);
+   
+   // an overflow which is pending isn't counted in msTick yet
+   if( __HAL_TIM_GET_FLAG(&TIM3_Handle, TIM_FLAG_UPDATE) != RESET )
+   {
+      remainder = msRemainder + __HAL_TIM_GET_COUNTER(&TIM3_Handle) + period;
+   }
+   __enable_irq();
+   
+   return ms + remainder/TICKS_PER_MS;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Number of frames which took longer than their period.
+///
+/// \param     none
+///
+/// \return    uint32_t overruns
+uint32_t Scheduler_getOverruns( void )
+{
+   return overruns;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Initialisation of the Timer.
+///
+/// \param     none
+///
+/// \return    Scheduler_StatusTypeDef
+static Scheduler_StatusTypeDef init_timer( void )
+{
+   uint16_t                     PrescalerValue;
+   
+   
+   // TIM3 Periph clock enable
+   __HAL_RCC_TIM3_CLK_ENABLE();
+   
+   // set prescaler to get the scheduler timer clock
+   PrescalerValue = (uint16_t) (SystemCoreClock / SCHEDULER_TIMER_HZ) - 1;
+   
+   // Time base configuration
+   TIM3_Handle.Instance                = TIM3;
+   TIM3_Handle.Init.Period             = period-1u; // one frame
+   TIM3_Handle.Init.Prescaler          = PrescalerValue;
+   TIM3_Handle.Init.ClockDivision      = 0;
+   TIM3_Handle.Init.CounterMode        = TIM_COUNTERMODE_UP;
+   TIM3_Handle.Init.RepetitionCounter  = 0;
+   TIM3_Handle.Init.AutoReloadPreload  = TIM_AUTORELOAD_PRELOAD_DISABLE;
+   if( HAL_TIM_Base_Init(&TIM3_Handle) != HAL_OK )
+   {
+     return Scheduler_ERROR;
+   }
+   
+   // only overflows generate an interrupt, not the update event on a clock change
+   __HAL_TIM_URS_ENABLE(&TIM3_Handle);
+
+   // configure TIM3 interrupt
+   HAL_NVIC_SetPriority(TIM3_IRQn, 5, 5);
+   HAL_NVIC_EnableIRQ(TIM3_IRQn);
+   
+   // start the timer
+   if( HAL_TIM_Base_Start_IT(&TIM3_Handle) != HAL_OK )
+   {
+      return Scheduler_ERROR;
+   }
+   
+   return Scheduler_OK;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Timer 3 interrupt handler, once per frame period.
+///
+/// \param      none
+///
+/// \return     none
+void TIM3_IRQHandler( void )
+{
+   // handle the irq
+   if (__HAL_TIM_GET_FLAG(&TIM3_Handle, TIM_FLAG_UPDATE) != RESET)
+   {
+      if (__HAL_TIM_GET_IT_SOURCE(&TIM3_Handle, TIM_IT_UPDATE) != RESET)
+      {
+         __HAL_TIM_CLEAR_IT(&TIM3_Handle, TIM_IT_UPDATE);
+      }
+   }
+   
+   // count the period into the millisecond clock
+   uint32_t remainder = msRemainder + period;
+   msTick         += remainder/TICKS_PER_MS;
+   msRemainder    = remainder%TICKS_PER_MS;
+   
+   frameTick++;
+}
\ No newline at end of file
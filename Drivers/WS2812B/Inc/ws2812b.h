@@ -47,11 +47,80 @@
 
 // Include ********************************************************************
 #include "stm32f1xx_hal.h"
+#include "cycles.h"
 
 // Exported defines ***********************************************************
 // define size of the ws2812b matrice
 #define COL                    ( 115u )    // LED pixel number
-#define ROW                    ( 2u )     // LED stripe number
+#define ROW                    ( 2u )     // LED stripe number, 1..16 (stripe n on GPIOA pin n)
+
+// led chip, selects the bit timing and the reset period
+#define WS2812B_CHIP_WS2812B   ( 0u )
+#define WS2812B_CHIP_WS2811    ( 1u )     // 400 kHz mode
+#define WS2812B_CHIP_SK6812    ( 2u )
+#define WS2812B_CHIP_WS2813    ( 3u )
+#define WS2812B_CHIP           WS2812B_CHIP_WS2812B
+
+// led color channels, channel index 0 red, 1 green, 2 blue, 3 white
+#define WS2812B_LED_BYTES      ( 3u )     // bytes of the widest leds, 3: rgb leds only, 4: rgbw leds (e.g. SK6812 RGBW) on at least one stripe
+#define WS2812B_STRIPE_BYTES   { 3u, 3u } // bytes per led of each stripe, 3 or WS2812B_LED_BYTES, ROW entries
+
+// wire order of the color channels, channel index per wire byte, the white channel is always sent last
+#define WS2812B_ORDER_RGB      { 0u, 1u, 2u, 3u }
+#define WS2812B_ORDER_RBG      { 0u, 2u, 1u, 3u }
+#define WS2812B_ORDER_GRB      { 1u, 0u, 2u, 3u }
+#define WS2812B_ORDER_GBR      { 1u, 2u, 0u, 3u }
+#define WS2812B_ORDER_BRG      { 2u, 0u, 1u, 3u }
+#define WS2812B_ORDER_BGR      { 2u, 1u, 0u, 3u }
+#define WS2812B_ORDERS         { WS2812B_ORDER_GRB, WS2812B_ORDER_GRB }   // one order per stripe, ROW entries
+
+// interrupt priority of the transfer complete which calls the send callback
+#define WS2812B_IRQ_PRIORITY   ( 5u )     // must equal BUTTON_IRQ_PRIORITY, both callbacks enqueue into the event queue
+
+// frame buffering
+#define WS2812B_DOUBLE_BUFFER  ( 1u )     // 1: the frame is encoded into a back buffer while the front buffer is transmitted, 0: single buffer
+#define WS2812B_STREAMING      ( 0u )     // 1: the rgb frame is encoded on the fly into a small dma ring, 0: whole frame encoded in ram on sending
+#define WS2812B_STREAM_PIXELS  ( 4u )     // pixels per half of the dma ring in streaming mode
+
+// transmission length
+#define WS2812B_PREFIX         ( 1u )     // 1: only the leds up to the last changed pixel are transmitted, the rest of the chain keeps its colour, 0: always the whole chain
+
+// color correction, applied by the encoder
+#define WS2812B_GAMMA_LINEAR   ( 0u )     // no correction
+#define WS2812B_GAMMA_2_0      ( 1u )     // out = in^2
+#define WS2812B_GAMMA_3_0      ( 2u )     // out = in^3
+#define WS2812B_GAMMA          WS2812B_GAMMA_2_0
+#define WS2812B_BRIGHTNESS     ( 255u )   // brightness after init, 0..255
+#define WS2812B_DITHER         ( 0u )     // 1: 16 bit per color frame, quantized to 8 bit with sigma-delta dithering over the frames, every frame is sent completely and never reported unchanged (WS2812B_READY), 0: 8 bit per color
+
+// power limit, the brightness is reduced on sending while the estimated current of the frame exceeds the budget
+#define WS2812B_POWER_LIMIT    ( 1u )     // 1: estimate the current and limit the brightness, 0: no limit
+#define WS2812B_POWER_BUDGET_MA ( 2000u ) // supply current available for the leds in mA
+#define WS2812B_CHANNEL_MA     ( 20u )    // current of one color channel fully on in mA
+#define WS2812B_IDLE_MA        ( 1u )     // quiescent current of one led in mA
+
+// pixel column encoder
+#define WS2812B_ENCODER_SHIFTMASK  ( 0u ) // one shift and mask per bit and stripe
+#define WS2812B_ENCODER_TRANSPOSE  ( 1u ) // 8x8 bit matrix transpose over 8 stripes at once
+#define WS2812B_ENCODER            WS2812B_ENCODER_TRANSPOSE
+
+// single pixel writes
+#define WS2812B_BITBAND        ( 0u )     // 1: each stripe bit is written with one store through the sram bit-band alias (checked by WS2812B_test on the target only), 0: read-modify-write with shift and mask
+
+// waiting on the transfer
+#define WS2812B_SLEEP          ( 1u )     // 1: the core sleeps with wfi until the next interrupt, 0: busy wait
+
+// pixel mapping, zones are resolved to physical pixels at compile time
+#define WS2812B_CHECK( cond )                        ( 0u*sizeof( char[(cond) ? 1 : -1] ) )  // 0, the array size is negative and the build fails if cond is false
+#define WS2812B_MIRROR( col )                        ( COL-1u-(col) )                        // physical col on a stripe mounted the other way round
+#define WS2812B_SERPENTINE( x, y, width )            ( (y)*(width) + ( ( ( (y) & 1u ) != 0u ) ? (width)-1u-(x) : (x) ) ) // physical col of a matrix folded row by row onto one stripe
+#define WS2812B_SPAN( row, col_start, col_end )      { (uint8_t)( (row) + WS2812B_CHECK( (row) < ROW ) ), (uint16_t)(col_start), \
+                                                       (uint16_t)( (col_end)-(col_start)+1u + WS2812B_CHECK( (col_start) <= (col_end) && (col_end) < COL ) ) }
+#define WS2812B_SPAN_MIRROR( row, col_start, col_end ) WS2812B_SPAN( row, WS2812B_MIRROR( col_end ), WS2812B_MIRROR( col_start ) )
+#define WS2812B_SPAN_SERPENTINE( row, x_start, x_end, y, width ) \
+   WS2812B_SPAN( row, WS2812B_SERPENTINE( ( ( (y) & 1u ) != 0u ) ? (x_end) : (x_start), y, width ), WS2812B_SERPENTINE( ( ( (y) & 1u ) != 0u ) ? (x_start) : (x_end), y, width ) )
+#define WS2812B_PIXEL( row, col )                    WS2812B_SPAN( row, col, col )
+#define WS2812B_ZONE( spans )                        { spans, (uint16_t)( sizeof(spans)/sizeof(spans[0]) ) }
 
 // Exported types *************************************************************
 typedef enum
@@ -64,9 +133,50 @@ typedef enum
    WS2812B_RESET    = 0x05U
 } WS2812B_StatusTypeDef;
 
+typedef void (*WS2812B_CallbackTypeDef)( void );
+
+typedef struct
+{
+   uint8_t  row;
+   uint16_t col;     // first pixel
+   uint16_t count;   // consecutive pixels, a span ends on its own stripe
+} WS2812B_SpanTypeDef;
+
+typedef struct
+{
+   const WS2812B_SpanTypeDef  *spans;
+   uint16_t                   count;
+} WS2812B_ZoneTypeDef;
+
 // Exported functions *********************************************************
 WS2812B_StatusTypeDef   WS2812B_init            ( void );
+WS2812B_StatusTypeDef   WS2812B_updateClock     ( void );
 void                    WS2812B_sendBuffer      ( void );
+WS2812B_StatusTypeDef   WS2812B_sendBufferAsync ( WS2812B_CallbackTypeDef callback );
+WS2812B_StatusTypeDef   WS2812B_getState        ( void );
 void                    WS2812B_clearBuffer     ( void );
 void                    WS2812B_setPixel        ( uint8_t row, uint16_t col, uint8_t red, uint8_t green, uint8_t blue );
+#if( WS2812B_LED_BYTES == 4u )
+void                    WS2812B_setPixelRGBW    ( uint8_t row, uint16_t col, uint8_t red, uint8_t green, uint8_t blue, uint8_t white );
+#endif
+#if( WS2812B_DITHER == 1u )
+void                    WS2812B_setPixel16      ( uint8_t row, uint16_t col, uint16_t red, uint16_t green, uint16_t blue );
+#endif
+WS2812B_StatusTypeDef   WS2812B_getPixel        ( uint8_t row, uint16_t col, uint8_t *red, uint8_t *green, uint8_t *blue );
+#if( WS2812B_LED_BYTES == 4u )
+WS2812B_StatusTypeDef   WS2812B_getPixelRGBW    ( uint8_t row, uint16_t col, uint8_t *red, uint8_t *green, uint8_t *blue, uint8_t *white );
+#endif
+void                    WS2812B_setColumn       ( uint16_t col, const uint8_t *rgb );
+void                    WS2812B_fillSpan        ( uint8_t row, uint16_t col_start, uint16_t col_end, uint8_t red, uint8_t green, uint8_t blue );
+void                    WS2812B_fillRect        ( uint8_t row_start, uint16_t col_start, uint8_t row_end, uint16_t col_end, uint8_t red, uint8_t green, uint8_t blue );
+void                    WS2812B_fillAll         ( uint8_t red, uint8_t green, uint8_t blue );
+void                    WS2812B_fillZone        ( const WS2812B_ZoneTypeDef *zone, uint8_t red, uint8_t green, uint8_t blue );
+void                    WS2812B_setBrightness   ( uint8_t brightness );
+#if( CYCLES_ENABLE == 1u )
+uint32_t                WS2812B_getEncodeCycles ( void );
+#endif
+#if( WS2812B_POWER_LIMIT == 1u )
+uint32_t                WS2812B_getCurrent      ( void );
+#endif
+WS2812B_StatusTypeDef   WS2812B_test            ( void );
 #endif // __WS2812B_H
\ No newline at end of file
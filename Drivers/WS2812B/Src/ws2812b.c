@@ -42,24 +42,241 @@
 // ****************************************************************************
 
 // Include ********************************************************************
+#include <stdbool.h>
+#include <string.h>
 #include "ws2812b.h"
+#include "cycles.h"
 
 // Private define *************************************************************
+#if ( ROW < 1u ) || ( ROW > 16u )
+#error "ROW must be between 1 and 16, one led stripe per GPIOA pin"
+#endif
+
+#if( WS2812B_STREAMING == 1u ) && ( WS2812B_STREAM_PIXELS < 1u )
+#error "WS2812B_STREAM_PIXELS must be at least 1"
+#endif
+
+/* chip profiles in ns: high time of a 0 and a 1 bit (centre of the datasheet window), bit period and minimum reset period */
+#if( WS2812B_CHIP == WS2812B_CHIP_WS2812B )
+#define CHIP_T0H_NS             ( 375u )
+#define CHIP_T1H_NS             ( 875u )
+#define CHIP_PERIOD_NS          ( 1250u )
+#define CHIP_RESET_NS           ( 50000u )
+#elif( WS2812B_CHIP == WS2812B_CHIP_WS2811 )
+#define CHIP_T0H_NS             ( 500u )
+#define CHIP_T1H_NS             ( 1200u )
+#define CHIP_PERIOD_NS          ( 2500u )
+#define CHIP_RESET_NS           ( 50000u )
+#elif( WS2812B_CHIP == WS2812B_CHIP_SK6812 )
+#define CHIP_T0H_NS             ( 300u )
+#define CHIP_T1H_NS             ( 600u )
+#define CHIP_PERIOD_NS          ( 1250u )
+#define CHIP_RESET_NS           ( 80000u )
+#elif( WS2812B_CHIP == WS2812B_CHIP_WS2813 )
+#define CHIP_T0H_NS             ( 375u )
+#define CHIP_T1H_NS             ( 875u )
+#define CHIP_PERIOD_NS          ( 1250u )
+#define CHIP_RESET_NS           ( 280000u )
+#else
+#error "unknown WS2812B_CHIP"
+#endif
+
+/* TIM2 counter clock after the prescaler, the timer values are derived from it */
+#define TIMER_CLOCK_HZ          ( 24000000u )
+#define NS_TO_TICKS(ns)         ( ((ns)*(TIMER_CLOCK_HZ/1000000u) + 500u) / 1000u )   // rounded
+#define NS_TO_TICKS_CEIL(ns)    ( ((ns)*(TIMER_CLOCK_HZ/1000000u) + 999u) / 1000u )   // rounded up
+
+#define TICKS_T0H               NS_TO_TICKS(CHIP_T0H_NS)         // cc1, data slot
+#define TICKS_T1H               NS_TO_TICKS(CHIP_T1H_NS)         // cc2, low slot
+#define TICKS_PERIOD            NS_TO_TICKS(CHIP_PERIOD_NS)      // bit period, arr+1
+#define TICKS_RESET             NS_TO_TICKS_CEIL(CHIP_RESET_NS)  // reset period, never shorter than the chip minimum
+
+/* the reset period is sent as trailing low bit slots, counted from the end of the last data bit */
+#define RESET_SLOTS             ( (TICKS_RESET + TICKS_PERIOD - 1u) / TICKS_PERIOD )
+
+#if ( TICKS_T0H < 1u ) || ( TICKS_T1H <= TICKS_T0H ) || ( TICKS_PERIOD <= TICKS_T1H )
+#error "the chip timing cannot be resolved with TIMER_CLOCK_HZ"
+#endif
+
+#if( COL*WS2812B_LED_BYTES*8u + RESET_SLOTS > 65535u )
+#error "the frame and the reset period don't fit into the 16 bit DMA transfer counter"
+#endif
+
+#if( WS2812B_ENCODER == WS2812B_ENCODER_TRANSPOSE )
+#define encode_column           encode_column_transpose
+#elif( WS2812B_ENCODER == WS2812B_ENCODER_SHIFTMASK )
+#define encode_column           encode_column_shiftmask
+#else
+#error "unknown WS2812B_ENCODER"
+#endif
+
+#if( WS2812B_BITBAND == 1u )
+#define encode_pixel            encode_pixel_bitband
+#else
+#define encode_pixel            encode_pixel_shiftmask
+#endif
+
+// the interrupts are masked between the check and wfi, so the interrupt which
+// changes the condition can't slip in before the core sleeps, it is pending
+// and wakes the core nevertheless
+#if( WS2812B_SLEEP == 1u )
+#define WAIT_WHILE(cond)        do { __disable_irq(); while( cond ) { __WFI(); __enable_irq(); __disable_irq(); } __enable_irq(); } while( 0 )
+#else
+#define WAIT_WHILE(cond)        do { while( cond ) { __NOP(); } } while( 0 )
+#endif
+
+#if( WS2812B_BRIGHTNESS > 255u )
+#error "WS2812B_BRIGHTNESS must be between 0 and 255"
+#endif
+
+#if ( WS2812B_LED_BYTES != 3u ) && ( WS2812B_LED_BYTES != 4u )
+#error "WS2812B_LED_BYTES must be 3 (rgb) or 4 (rgbw on at least one stripe)"
+#endif
+
+#if( WS2812B_DITHER == 1u ) && ( WS2812B_STREAMING == 1u )
+#error "WS2812B_DITHER requires the whole frame encoded on sending, WS2812B_STREAMING must be 0"
+#endif
+
+/* gamma curve, evaluated by the compiler with rounded integer math */
+#if( WS2812B_DITHER == 1u )
+/* 257 nodes for input x/256, output in 8.8 fixed point 0..255.0 */
+#if( WS2812B_GAMMA == WS2812B_GAMMA_LINEAR )
+#define GAMMA(x)                ( (uint16_t)((x)*255u) )
+#elif( WS2812B_GAMMA == WS2812B_GAMMA_2_0 )
+#define GAMMA(x)                ( (uint16_t)(((x)*(x)*255u + 128u) / 256u) )
+#elif( WS2812B_GAMMA == WS2812B_GAMMA_3_0 )
+#define GAMMA(x)                ( (uint16_t)(((x)*(x)*(x)*255u + 32768u) / 65536u) )
+#else
+#error "unknown WS2812B_GAMMA"
+#endif
+#else
+#if( WS2812B_GAMMA == WS2812B_GAMMA_LINEAR )
+#define GAMMA(x)                ( (uint8_t)(x) )
+#elif( WS2812B_GAMMA == WS2812B_GAMMA_2_0 )
+#define GAMMA(x)                ( (uint8_t)(((x)*(x) + 127u) / 255u) )
+#elif( WS2812B_GAMMA == WS2812B_GAMMA_3_0 )
+#define GAMMA(x)                ( (uint8_t)(((x)*(x)*(x) + 32512u) / 65025u) )
+#else
+#error "unknown WS2812B_GAMMA"
+#endif
+#endif
+#define GAMMA_4(x)              GAMMA(x), GAMMA((x)+1u), GAMMA((x)+2u), GAMMA((x)+3u)
+#define GAMMA_16(x)             GAMMA_4(x), GAMMA_4((x)+4u), GAMMA_4((x)+8u), GAMMA_4((x)+12u)
+#define GAMMA_64(x)             GAMMA_16(x), GAMMA_16((x)+16u), GAMMA_16((x)+32u), GAMMA_16((x)+48u)
+#define GAMMA_256               GAMMA_64(0u), GAMMA_64(64u), GAMMA_64(128u), GAMMA_64(192u)
+
+/* power of a frame color at full brightness, 0..255 */
+#if( WS2812B_DITHER == 1u )
+#define POWER(x)                ( WS2812_Gamma[(x) >> 8u] >> 8u )
+#else
+#define POWER(x)                ( WS2812_Gamma[x] )
+#endif
+
+/* color value of the frame and the color correction of the encoders */
+#if( WS2812B_DITHER == 1u )
+#define COLOR(x)                ( (uint16_t)((x)*257u) )   // 8 bit color to frame color
+#define COLOR_8(x)              ( (uint8_t)((x) >> 8u) )   // frame color to 8 bit color
+#define CORRECT(x)              ( x )                      // already corrected while dithering
+#else
+#define COLOR(x)                ( x )
+#define COLOR_8(x)              ( x )
+#define CORRECT(x)              ( WS2812_Lut[x] )
+#endif
+
+/* bit-band alias word of a bit in sram */
+#define BITBAND_SRAM(address, bit)  ((volatile uint32_t*)(SRAM_BB_BASE + (((uint32_t)(address) - SRAM_BASE) << 5u) + ((uint32_t)(bit) << 2u)))
+
 
 // Private types     **********************************************************
+/* color value of the rgb frame */
+#if( WS2812B_DITHER == 1u )
+typedef uint16_t WS2812_Color_t;
+#else
+typedef uint8_t WS2812_Color_t;
+#endif
+
+/* range of changed pixels of one stripe */
+typedef struct
+{
+   uint16_t    col_start;     // first changed pixel
+   uint16_t    col_end;       // last changed pixel, inclusive, the range is empty if col_start > col_end
+}WS2812_Dirty_t;
+
+/* number of bit slots of a pixel and of a complete frame, one halfword per bit slot carries the bit of every stripe (bit n = stripe n) */
+#define PIXEL_SLOTS             ( WS2812B_LED_BYTES*8u )
+#define FRAME_SLOTS             ( COL*PIXEL_SLOTS )   // see COL as LED pixel number on the stripe, the stripes (ROW) are packed into the halfword bits
+
+/* wire bytes of a stripe in the frame, byte n of every stripe is sent in the slots of byte n, a stripe with 3 byte leds ends before a rgbw stripe */
+#define FRAME_BYTES             ( COL*WS2812B_LED_BYTES )
+
 /* WS2812 GPIO output buffer size */
-#define GPIO_BUFFERSIZE         ROW*COL*24u   // see ROW as LED stripe number and COL LED pixel number on the stripe
+#if( WS2812B_STREAMING == 1u )
+#define GPIO_BUFFERSIZE         ( 2u*WS2812B_STREAM_PIXELS*PIXEL_SLOTS )   // ring of two halves, one is encoded while the other one is transferred
+#else
+#define GPIO_BUFFERSIZE         FRAME_SLOTS
+#endif
+
+/* number of GPIO output buffers */
+#if( WS2812B_DOUBLE_BUFFER == 1u )
+#define GPIO_BUFFERS            ( 2u )
+#else
+#define GPIO_BUFFERS            ( 1u )
+#endif
 
 // Private variables **********************************************************
 static const uint16_t                 WS2812_High  = 0xFFFF;
 static const uint16_t                 WS2812_Low   = 0x0000;
-static       uint16_t                 WS2812_Buffer[GPIO_BUFFERSIZE];      // ROW * COL * 24 bits (R(8bit), G(8bit), B(8bit)) = y --- output array transferred to GPIO output --- 1 array entry contents 16 bits parallel to GPIO outp
-static       WS2812B_StatusTypeDef    WS2812_State = WS2812B_RESET;
+static const uint8_t                  WS2812_Order[][4] = WS2812B_ORDERS;     // channel index per wire byte and stripe
+static const uint8_t                  WS2812_Bytes[] = WS2812B_STRIPE_BYTES;  // bytes per led and stripe
+#if( WS2812B_DITHER == 1u )
+static const uint16_t                 WS2812_Gamma[257] = { GAMMA_256, GAMMA(256u) };  // gamma curve in flash
+static       uint16_t                 WS2812_Lut[257];                    // brightness scaled gamma curve, interpolated while dithering
+static       uint8_t                  WS2812_Error[ROW][FRAME_BYTES];     // quantization error carried to the next frame
+#else
+static const uint8_t                  WS2812_Gamma[256] = { GAMMA_256 };  // gamma curve in flash
+static       uint8_t                  WS2812_Lut[256];                    // brightness scaled gamma curve, looked up by the encoders
+#endif
+static       WS2812_Color_t           WS2812_Frame[ROW][FRAME_BYTES];     // rgb(w) frame in which the pixels are drawn, the colors of each stripe in wire order, zero behind shorter stripes
+#if( WS2812B_STREAMING == 1u )
+static       uint16_t                 WS2812_Buffer[GPIO_BUFFERSIZE];      // ring of encoded bit slots transferred to GPIO output
+#if( WS2812B_DOUBLE_BUFFER == 1u )
+static       WS2812_Color_t           WS2812_Wire[ROW][FRAME_BYTES];      // copy of the frame which is streamed to the leds
+#define      WS2812_Source            WS2812_Wire
+#else
+#define      WS2812_Source            WS2812_Frame
+#endif
+static volatile uint16_t              WS2812_StreamCol;                   // next pixel column to encode into the ring
+static volatile uint16_t              WS2812_StreamEnd;                   // pixels of the frame on the wire, the ring is zero behind them
+#else
+static __ALIGNED(4) uint16_t          WS2812_Buffer[GPIO_BUFFERS][GPIO_BUFFERSIZE];      // COL * 24 bits (G(8bit), R(8bit), B(8bit)) --- output array transferred to GPIO output --- 1 array entry contents 16 bits parallel to GPIO output, 1 bit per stripe
+static       uint16_t*                WS2812_Front = WS2812_Buffer[0];     // buffer which is transferred to the leds
+static       uint16_t*                WS2812_Back  = WS2812_Buffer[GPIO_BUFFERS-1u]; // buffer in which the frame is encoded, same as the front buffer in single buffer mode
+#endif
+static       WS2812_Dirty_t           WS2812_Dirty[ROW];                   // pixels changed since the last send
+#if( WS2812B_STREAMING == 0u ) && ( WS2812B_DOUBLE_BUFFER == 1u )
+static       WS2812_Dirty_t           WS2812_Stale[ROW];                   // pixels changed for the front buffer which are outdated in the back buffer
+#endif
+static volatile uint16_t              WS2812_Length = COL;                 // pixel columns (PIXEL_SLOTS each) to transmit of the next started frame
+static       uint8_t                  WS2812_Brightness;                  // brightness set by the application
+static       uint8_t                  WS2812_LutBrightness;               // brightness of the color table, reduced by the power limit
+#if( WS2812B_POWER_LIMIT == 1u )
+static       uint32_t                 WS2812_Power;                       // sum of the gamma corrected colors at full brightness
+#endif
+static       WS2812B_CallbackTypeDef  WS2812_Callback = NULL;             // called once the frame on the wire has been latched
+static       WS2812B_CallbackTypeDef  WS2812_CallbackPending = NULL;      // callback of the queued frame
+static volatile bool                  WS2812_Pending = false;              // back buffer is queued and will be swapped in once the running frame has been latched
+static volatile WS2812B_StatusTypeDef WS2812_State = WS2812B_RESET;
 static       TIM_HandleTypeDef        TIM2_Handle;
 static       DMA_HandleTypeDef        DMA_HandleStruct_UEV;
 static       DMA_HandleTypeDef        DMA_HandleStruct_CC1;
 static       DMA_HandleTypeDef        DMA_HandleStruct_CC2;
 
+/* WS2812B_ORDERS must have one order per stripe, a missing one would be zero filled, the array size is -1 otherwise */
+typedef char WS2812_OrderCheck[ ( sizeof(WS2812_Order) == ROW*sizeof(WS2812_Order[0]) ) ? 1 : -1 ];
+
+/* WS2812B_STRIPE_BYTES must have one entry per stripe, the values are checked by WS2812B_init */
+typedef char WS2812_BytesCheck[ ( sizeof(WS2812_Bytes) == ROW ) ? 1 : -1 ];
+
 // Private function prototypes ************************************************
 static WS2812B_StatusTypeDef    init_timer              ( void );
 static WS2812B_StatusTypeDef    init_dma                ( void );
@@ -67,7 +284,43 @@ static WS2812B_StatusTypeDef    init_gpio               ( void );
 static void                     DMA_SetConfiguration    ( DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength );
 static void                     TransferComplete        ( DMA_HandleTypeDef *DmaHandle );
 static void                     TransferError           ( DMA_HandleTypeDef *DmaHandle );
-static void                     WS2812_TIM2_callback    ( void );
+static void                     wait_back_buffer        ( void );
+static void                     wait_frame              ( void );
+static void                     mark_dirty              ( uint8_t row, uint16_t col_start, uint16_t col_end );
+static bool                     is_dirty                ( void );
+static WS2812_Dirty_t           dirty_columns           ( uint8_t row, WS2812_Dirty_t range );
+#if( WS2812B_PREFIX == 1u )
+static uint16_t                 whole_leds              ( uint16_t length );
+#endif
+static void                     store_pixel             ( uint8_t row, uint16_t col, const WS2812_Color_t *color );
+static void                     fill_span               ( uint8_t row, uint16_t col_start, uint16_t count, const WS2812_Color_t *color );
+static void                     load_pixel              ( uint8_t row, uint16_t col, WS2812_Color_t *color );
+static void                     build_lut               ( uint8_t brightness );
+#if( WS2812B_POWER_LIMIT == 1u )
+static void                     account_pixel           ( const WS2812_Color_t *pixel, const WS2812_Color_t *wire, uint8_t bytes );
+static uint32_t                 estimate_current        ( uint8_t brightness );
+static uint8_t                  limit_brightness        ( void );
+#endif
+#if( WS2812B_DITHER == 1u )
+static uint16_t                 correct                 ( uint16_t color );
+#endif
+#if( WS2812B_STREAMING == 0u )
+static void                     encode_frame            ( void );
+#endif
+static void                     swap_buffers            ( void );
+static void                     start_transfer          ( void );
+static void                     encode_column_shiftmask ( uint16_t *slots, const uint8_t *pixel, uint16_t stride );
+static void                     encode_column_transpose ( uint16_t *slots, const uint8_t *pixel, uint16_t stride );
+static void                     transpose_byte          ( uint16_t *slots, const uint8_t *pixel, uint8_t byte, uint16_t stride );
+static void                     encode_pixel_shiftmask  ( uint16_t *slots, uint8_t row, const uint8_t *pixel );
+#if( WS2812B_BITBAND == 1u )
+static void                     encode_pixel_bitband    ( uint16_t *slots, uint8_t row, const uint8_t *pixel );
+#endif
+#if( WS2812B_STREAMING == 1u )
+static void                     stream_fill             ( uint16_t *slots );
+static void                     StreamHalfComplete      ( DMA_HandleTypeDef *DmaHandle );
+static void                     StreamComplete          ( DMA_HandleTypeDef *DmaHandle );
+#endif
 
 // Global variables ***********************************************************
 
@@ -80,6 +333,16 @@ static void                     WS2812_TIM2_callback    ( void );
 /// \return    none
 WS2812B_StatusTypeDef WS2812B_init( void )
 {   
+   // every stripe has rgb leds or the widest leds of the frame
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      if( WS2812_Bytes[row] != 3u && WS2812_Bytes[row] != WS2812B_LED_BYTES )
+      {
+         WS2812_State = WS2812B_ERROR;
+         return WS2812_State;
+      }
+   }
+   
    // init peripherals
    if( init_gpio() != WS2812B_OK )
    {
@@ -102,9 +365,41 @@ WS2812B_StatusTypeDef WS2812B_init( void )
    // set the ws2812b state flag to ready for operation
    WS2812_State = WS2812B_READY;
    
+   // build the color table, this marks the whole first frame for sending
+   WS2812B_setBrightness( WS2812B_BRIGHTNESS );
+   
    return WS2812_State;
 }
 
+// ----------------------------------------------------------------------------
+/// \brief     Derives the TIM2 prescaler again from SystemCoreClock after the
+///            system clock has been changed. Must be called while no frame
+///            is on the wire, the bit timing stays the same at every system
+///            clock which is a multiple of TIMER_CLOCK_HZ.
+///
+/// \param     none
+///
+/// \return    WS2812B_StatusTypeDef, WS2812B_BUSY while a frame is on the wire
+WS2812B_StatusTypeDef WS2812B_updateClock( void )
+{
+   if( SystemCoreClock % TIMER_CLOCK_HZ != 0u )
+   {
+      return WS2812B_ERROR;
+   }
+   
+   if( WS2812_State != WS2812B_READY )
+   {
+      return WS2812B_BUSY;
+   }
+   
+   // the prescaler is loaded by the update event, TIM2 is stopped and its dma requests are disabled
+   __HAL_TIM_SET_PRESCALER(&TIM2_Handle, SystemCoreClock/TIMER_CLOCK_HZ - 1u);
+   TIM2->EGR = TIM_EGR_UG;
+   TIM2->SR  = 0;
+   
+   return WS2812B_OK;
+}
+
 // ----------------------------------------------------------------------------
 /// \brief     Initialisation of the Timer.
 ///
@@ -120,12 +415,16 @@ static WS2812B_StatusTypeDef init_timer( void )
    // TIM2 Periph clock enable
    __HAL_RCC_TIM2_CLK_ENABLE();
    
-   // set prescaler to get a 24 MHz clock signal
-   PrescalerValue = (uint16_t) (SystemCoreClock / 24000000) - 1;
+   // set prescaler to get the timer clock signal
+   if( SystemCoreClock % TIMER_CLOCK_HZ != 0u )
+   {
+      return WS2812B_ERROR;
+   }
+   PrescalerValue = (uint16_t) (SystemCoreClock / TIMER_CLOCK_HZ) - 1;
    
    // Time base configuration
    TIM2_Handle.Instance                 = TIM2;
-   TIM2_Handle.Init.Period              = 29;                // set the period to get 29 to get a 800kHz timer -> T=1250 ns, NOTE: the ARR will be set for data transmission and also set for the deadtime/reset timer, so the arr value changes 2 time per complete led write attempt
+   TIM2_Handle.Init.Period              = TICKS_PERIOD-1u;   // bit period of the chip, e.g. 30 ticks => 1250 ns (800 kHz), the reset period is sent as low bit slots with the same period
    TIM2_Handle.Init.Prescaler           = PrescalerValue;
    TIM2_Handle.Init.ClockDivision       = 0;
    TIM2_Handle.Init.CounterMode         = TIM_COUNTERMODE_UP;
@@ -137,7 +436,7 @@ static WS2812B_StatusTypeDef init_timer( void )
    // Timing Mode configuration: Capture Compare 1
    TIM_OC1Struct.OCMode                 = TIM_OCMODE_TIMING;
    TIM_OC1Struct.OCPolarity             = TIM_OCPOLARITY_HIGH;
-   TIM_OC1Struct.Pulse                  = 9;                    // 9 pulses => 9/30 => (8/30)*1250ns = 375 ns, ws2812b datasheet: 350 ns
+   TIM_OC1Struct.Pulse                  = TICKS_T0H;            // high time of a 0 bit, ws2812b: 9 ticks => 375 ns
    
    // Configure the channel
    if( HAL_TIM_OC_ConfigChannel(&TIM2_Handle, &TIM_OC1Struct, TIM_CHANNEL_1) != HAL_OK )
@@ -148,7 +447,7 @@ static WS2812B_StatusTypeDef init_timer( void )
    // Timing Mode configuration: Capture Compare 2
    TIM_OC2Struct.OCMode                 = TIM_OCMODE_TIMING;
    TIM_OC2Struct.OCPolarity             = TIM_OCPOLARITY_HIGH;
-   TIM_OC2Struct.Pulse                  = 21;                   // 21 pulses => 21/29 => (21/29)*1250ns = 905.17 ns, ws2812b datasheet: 900 ns
+   TIM_OC2Struct.Pulse                  = TICKS_T1H;            // high time of a 1 bit, ws2812b: 21 ticks => 875 ns
 
    // Configure the channel
    if( HAL_TIM_OC_ConfigChannel(&TIM2_Handle, &TIM_OC2Struct, TIM_CHANNEL_2) != HAL_OK )
@@ -156,10 +455,6 @@ static WS2812B_StatusTypeDef init_timer( void )
       return WS2812B_ERROR;
    }
    
-   // configure TIM2 interrupt
-   HAL_NVIC_SetPriority(TIM2_IRQn, 0, 2);
-   HAL_NVIC_EnableIRQ(TIM2_IRQn);
-   
    return WS2812B_OK;
 }
 
@@ -195,7 +490,11 @@ static WS2812B_StatusTypeDef init_dma( void )
    DMA_HandleStruct_CC1.Init.Direction 		      = DMA_MEMORY_TO_PERIPH;
    DMA_HandleStruct_CC1.Init.PeriphInc 		      = DMA_PINC_DISABLE;
    DMA_HandleStruct_CC1.Init.MemInc                = DMA_MINC_ENABLE;
+#if( WS2812B_STREAMING == 1u )
+   DMA_HandleStruct_CC1.Init.Mode                  = DMA_CIRCULAR;     // the ring is refilled on half and full transfer
+#else
    DMA_HandleStruct_CC1.Init.Mode                  = DMA_NORMAL;
+#endif
    DMA_HandleStruct_CC1.Init.PeriphDataAlignment 	= DMA_PDATAALIGN_HALFWORD;
    DMA_HandleStruct_CC1.Init.MemDataAlignment 		= DMA_MDATAALIGN_HALFWORD;
    DMA_HandleStruct_CC1.Init.Priority              = DMA_PRIORITY_HIGH;
@@ -224,11 +523,22 @@ static WS2812B_StatusTypeDef init_dma( void )
    HAL_DMA_RegisterCallback(&DMA_HandleStruct_CC2, HAL_DMA_XFER_ERROR_CB_ID, TransferError);
    
    // NVIC configuration for DMA transfer complete interrupt 
-   HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 0, 1);
+   HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, WS2812B_IRQ_PRIORITY, 1);
    
    // Enable interrupt
    HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
    
+#if( WS2812B_STREAMING == 1u )
+   // register the ring refill callbacks of the data channel
+   HAL_DMA_RegisterCallback(&DMA_HandleStruct_CC1, HAL_DMA_XFER_HALFCPLT_CB_ID, StreamHalfComplete);
+   HAL_DMA_RegisterCallback(&DMA_HandleStruct_CC1, HAL_DMA_XFER_CPLT_CB_ID, StreamComplete);
+   HAL_DMA_RegisterCallback(&DMA_HandleStruct_CC1, HAL_DMA_XFER_ERROR_CB_ID, TransferError);
+   
+   // NVIC configuration for DMA half and full transfer interrupt of the ring
+   HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 0, 0);
+   HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+#endif
+   
    return WS2812B_OK;
 }
 
@@ -252,26 +562,413 @@ static WS2812B_StatusTypeDef init_gpio( void )
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Send buffer to the ws2812b leds.
+/// \brief     Send buffer to the ws2812b leds, see WS2812B_sendBufferAsync.
 ///
 /// \param     none
 ///
 /// \return    none
 void WS2812B_sendBuffer( void )
 {
-   // wait until last buffer transmission has been completed
-   while( WS2812_State != WS2812B_READY );
-  
+   (void)WS2812B_sendBufferAsync( NULL );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Send buffer to the ws2812b leds. The changed pixels of the rgb
+///            frame are encoded into the back buffer. If no pixel has changed
+///            since the last send, nothing is transmitted since the leds
+///            already show the frame. With WS2812B_PREFIX only the leds up
+///            to the last changed pixel are clocked out. In double buffer
+///            mode the call doesn't block: if a frame is still on the wire,
+///            the back buffer is queued and swapped in by the transfer
+///            complete callback. The given callback is called from the
+///            transfer complete interrupt at WS2812B_IRQ_PRIORITY once the
+///            leds have latched the frame.
+///
+/// \param     [in] WS2812B_CallbackTypeDef callback, may be NULL
+///
+/// \return    WS2812B_StatusTypeDef, WS2812B_OK if the frame is sent and the
+///            callback follows, WS2812B_READY if nothing has changed, the
+///            leds already show the frame and the callback is not called
+WS2812B_StatusTypeDef WS2812B_sendBufferAsync( WS2812B_CallbackTypeDef callback )
+{
+   // only one frame can be queued behind the one on the wire
+   wait_back_buffer();
+   
+#if( WS2812B_DITHER == 1u )
+   // the dithered colors change every frame
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      mark_dirty( row, 0u, COL-1u );
+   }
+#endif
+   
+   // skip unchanged frames
+   if( is_dirty() == false )
+   {
+      return WS2812B_READY;
+   }
+   
+#if( WS2812B_POWER_LIMIT == 1u )
+   // dim the frame if it exceeds the power budget, a new table marks the whole frame
+   uint8_t brightness = limit_brightness();
+   if( brightness != WS2812_LutBrightness )
+   {
+      build_lut( brightness );
+   }
+#endif
+   
+#if( WS2812B_STREAMING == 0u )
+   // encode the changed pixels into the back buffer
+   CYCLES_START( CYCLES_ENCODE );
+   encode_frame();
+   CYCLES_STOP( CYCLES_ENCODE );
+#endif
+   
+#if( WS2812B_PREFIX == 1u )
+   // the chain is clocked out up to the last changed pixel, the leds behind keep their colour
+   uint16_t length = 0u;
+#endif
+   
+   // after the swap the new back buffer misses the changes of this frame
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+#if( WS2812B_PREFIX == 1u )
+      WS2812_Dirty_t columns = dirty_columns( row, WS2812_Dirty[row] );
+      
+      if( columns.col_start <= columns.col_end && columns.col_end >= length )
+      {
+         length = columns.col_end + 1u;
+      }
+#endif
+#if( WS2812B_STREAMING == 0u ) && ( WS2812B_DOUBLE_BUFFER == 1u )
+      WS2812_Stale[row] = WS2812_Dirty[row];
+#endif
+      WS2812_Dirty[row].col_start   = COL;
+      WS2812_Dirty[row].col_end     = 0u;
+   }
+   
+#if( WS2812B_PREFIX == 1u )
+   // no frame is queued anymore, the one on the wire has already latched its length
+   WS2812_Length = whole_leds( length );
+#endif
+   
+   // the transfer complete callback must not run between checking and queueing
+   __disable_irq();
+   if( WS2812_State == WS2812B_READY )
+   {
+      WS2812_Callback = callback;
+      swap_buffers();
+      start_transfer();
+   }
+   else
+   {
+      WS2812_CallbackPending = callback;
+      WS2812_Pending = true;
+   }
+   __enable_irq();
+   
+   return WS2812B_OK;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the state of the driver, WS2812B_BUSY while a frame is
+///            on the wire, WS2812B_READY once the leds have latched it.
+///
+/// \param     none
+///
+/// \return    WS2812B_StatusTypeDef
+WS2812B_StatusTypeDef WS2812B_getState( void )
+{
+   return WS2812_State;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Waits until the back buffer may be written. In single buffer
+///            mode this is the case once the last transmission has completed,
+///            in double buffer mode once the queued back buffer has been
+///            swapped to the front. With WS2812B_SLEEP the core sleeps until
+///            the transfer interrupts.
+///
+/// \param     none
+///
+/// \return    none
+static void wait_back_buffer( void )
+{
+   CYCLES_START( CYCLES_WAIT );
+#if( WS2812B_DOUBLE_BUFFER == 1u )
+   WAIT_WHILE( WS2812_Pending != false );
+#else
+   WAIT_WHILE( WS2812_State != WS2812B_READY );
+#endif
+   CYCLES_STOP( CYCLES_WAIT );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Waits until the rgb frame may be written. Only in streaming
+///            mode the frame is read while it is transmitted, directly or by
+///            the copy taken when the queued frame is swapped in.
+///
+/// \param     none
+///
+/// \return    none
+static void wait_frame( void )
+{
+#if( WS2812B_STREAMING == 1u )
+   wait_back_buffer();
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Extends the changed pixel range of a stripe.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col_start
+/// \param     [in] uint16_t col_end, inclusive
+///
+/// \return    none
+static void mark_dirty( uint8_t row, uint16_t col_start, uint16_t col_end )
+{
+   if( col_start < WS2812_Dirty[row].col_start )
+   {
+      WS2812_Dirty[row].col_start = col_start;
+   }
+   
+   if( col_end > WS2812_Dirty[row].col_end )
+   {
+      WS2812_Dirty[row].col_end = col_end;
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks if any pixel has changed since the last send.
+///
+/// \param     none
+///
+/// \return    bool
+static bool is_dirty( void )
+{
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      if( WS2812_Dirty[row].col_start <= WS2812_Dirty[row].col_end )
+      {
+         return true;
+      }
+   }
+   
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Converts a range of pixels of a stripe into the pixel columns of
+///            the slot buffer which carry their bytes. A column holds
+///            WS2812B_LED_BYTES wire bytes of every stripe, on a stripe with
+///            the widest leds it is the same pixel.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] WS2812_Dirty_t range, pixels of the stripe, may be empty
+///
+/// \return    WS2812_Dirty_t pixel columns, empty if the range is empty
+static WS2812_Dirty_t dirty_columns( uint8_t row, WS2812_Dirty_t range )
+{
+   if( range.col_start <= range.col_end )
+   {
+      range.col_start   = (uint16_t)((range.col_start*WS2812_Bytes[row])/WS2812B_LED_BYTES);
+      range.col_end     = (uint16_t)(((range.col_end+1u)*WS2812_Bytes[row] - 1u)/WS2812B_LED_BYTES);
+   }
+   
+   return range;
+}
+
+#if( WS2812B_PREFIX == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Extends a frame length until no led gets only a part of its
+///            bytes. With rgb and rgbw stripes a column may end inside a rgb
+///            led, every stripe must end on a whole led or behind its chain.
+///
+/// \param     [in] uint16_t length, pixel columns
+///
+/// \return    uint16_t pixel columns, at most COL
+static uint16_t whole_leds( uint16_t length )
+{
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      while( length*WS2812B_LED_BYTES < COL*WS2812_Bytes[row] && (length*WS2812B_LED_BYTES) % WS2812_Bytes[row] != 0u )
+      {
+         length++;
+      }
+   }
+   
+   return length;
+}
+#endif
+
+#if( WS2812B_DITHER == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Quantizes the 16 bit frame to 8 bit with sigma-delta dithering
+///            and encodes it completely into the back buffer. The remainder
+///            of each color is added to the color in the next frame, so the
+///            average over the frames has 16 bit resolution. The cost is
+///            fixed, one table interpolation per color and one column encoding
+///            per pixel column.
+///
+/// \param     none
+///
+/// \return    none
+static void encode_frame( void )
+{
+   uint8_t     column[ROW][WS2812B_LED_BYTES];
+   uint16_t    color;
+   
+   for( uint16_t col = 0; col < COL; col++ )
+   {
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         for( uint8_t i = 0; i < WS2812B_LED_BYTES; i++ )
+         {
+            uint16_t byte = col*WS2812B_LED_BYTES + i;
+            
+            // the corrected color is at most 255.0 in 8.8 fixed point, the sum doesn't overflow
+            color                      = correct( WS2812_Frame[row][byte] ) + WS2812_Error[row][byte];
+            column[row][i]             = (uint8_t)(color >> 8u);
+            WS2812_Error[row][byte]    = (uint8_t)color;
+         }
+      }
+      
+      encode_column( &WS2812_Back[col*PIXEL_SLOTS], &column[0][0], WS2812B_LED_BYTES );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Gamma and brightness correction of a 16 bit color, linear
+///            interpolation between the two nodes of the color table.
+///
+/// \param     [in] uint16_t color
+///
+/// \return    uint16_t corrected color, 8.8 fixed point
+static uint16_t correct( uint16_t color )
+{
+   uint16_t low  = WS2812_Lut[color >> 8u];
+   uint16_t high = WS2812_Lut[(color >> 8u) + 1u];
+   
+   return (uint16_t)(low + (((uint32_t)(high - low)*(color & 0xFFu)) >> 8u));
+}
+#elif( WS2812B_STREAMING == 0u )
+// ----------------------------------------------------------------------------
+/// \brief     Encodes the changed pixels of the rgb frame into the back
+///            buffer. If only a single stripe has changed, only its bits are
+///            written with the pixel encoder, otherwise the columns spanned
+///            by all changed stripes are encoded for all stripes at once.
+///
+/// \param     none
+///
+/// \return    none
+static void encode_frame( void )
+{
+   WS2812_Dirty_t    range;
+   uint16_t          col_start   = COL;
+   uint16_t          col_end     = 0u;
+   uint8_t           rows        = 0u;
+   uint8_t           row_dirty   = 0u;
+   
+   // pixels to encode per stripe, in double buffer mode also the ones which changed for the front buffer
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      range = WS2812_Dirty[row];
+#if( WS2812B_DOUBLE_BUFFER == 1u )
+      if( WS2812_Stale[row].col_start < range.col_start )
+      {
+         range.col_start = WS2812_Stale[row].col_start;
+      }
+      if( WS2812_Stale[row].col_end > range.col_end )
+      {
+         range.col_end = WS2812_Stale[row].col_end;
+      }
+#endif
+      range = dirty_columns( row, range );
+      if( range.col_start > range.col_end )
+      {
+         continue;
+      }
+      
+      rows++;
+      row_dirty = row;
+      
+      if( range.col_start < col_start )
+      {
+         col_start = range.col_start;
+      }
+      if( range.col_end > col_end )
+      {
+         col_end = range.col_end;
+      }
+   }
+   
+   if( rows == 1u )
+   {
+      for( uint16_t col = col_start; col <= col_end; col++ )
+      {
+         encode_pixel( &WS2812_Back[col*PIXEL_SLOTS], row_dirty, &WS2812_Frame[row_dirty][col*WS2812B_LED_BYTES] );
+      }
+   }
+   else if( rows > 1u )
+   {
+      for( uint16_t col = col_start; col <= col_end; col++ )
+      {
+         encode_column( &WS2812_Back[col*PIXEL_SLOTS], &WS2812_Frame[0][col*WS2812B_LED_BYTES], FRAME_BYTES );
+      }
+   }
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Swaps front and back buffer. The new back buffer keeps the
+///            content of the previously transmitted frame. In streaming mode
+///            the drawn frame is copied into the frame which is streamed.
+///
+/// \param     none
+///
+/// \return    none
+static void swap_buffers( void )
+{
+#if( WS2812B_STREAMING == 1u ) && ( WS2812B_DOUBLE_BUFFER == 1u )
+   memcpy( WS2812_Wire, WS2812_Frame, sizeof(WS2812_Wire) );
+#elif( WS2812B_DOUBLE_BUFFER == 1u )
+   uint16_t* buffer;
+   
+   buffer         = WS2812_Front;
+   WS2812_Front   = WS2812_Back;
+   WS2812_Back    = buffer;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Starts the transmission of the front buffer.
+///
+/// \param     none
+///
+/// \return    none
+static void start_transfer( void )
+{
    // transmission complete flag, indicate that transmission is taking place
    WS2812_State = WS2812B_BUSY;
+   CYCLES_START( CYCLES_TRANSFER );
    
-   // set period to 1.25 us with the auto reload register
-   TIM2->ARR = 29u;
+#if( WS2812B_STREAMING == 1u )
+   // encode the first pixels into both halves of the ring, the rest is encoded by the ring interrupts
+   WS2812_StreamCol = 0u;
+   WS2812_StreamEnd = WS2812_Length;
+   stream_fill( &WS2812_Buffer[0] );
+   stream_fill( &WS2812_Buffer[GPIO_BUFFERSIZE/2u] );
+#endif
    
-   // set configuration
-   DMA_SetConfiguration(&DMA_HandleStruct_UEV, (uint32_t)&WS2812_High, (uint32_t)&GPIOA->ODR, GPIO_BUFFERSIZE);
-   DMA_SetConfiguration(&DMA_HandleStruct_CC1, (uint32_t)&WS2812_Buffer[0], (uint32_t)&GPIOA->ODR, GPIO_BUFFERSIZE);
-   DMA_SetConfiguration(&DMA_HandleStruct_CC2, (uint32_t)&WS2812_Low, (uint32_t)&GPIOA->ODR, GPIO_BUFFERSIZE);
+   // set configuration, the high and data slots end with the frame length, the low slots continue through the reset period
+   DMA_SetConfiguration(&DMA_HandleStruct_UEV, (uint32_t)&WS2812_High, (uint32_t)&GPIOA->ODR, WS2812_Length*PIXEL_SLOTS);
+#if( WS2812B_STREAMING == 1u )
+   DMA_SetConfiguration(&DMA_HandleStruct_CC1, (uint32_t)WS2812_Buffer, (uint32_t)&GPIOA->ODR, GPIO_BUFFERSIZE);
+#else
+   DMA_SetConfiguration(&DMA_HandleStruct_CC1, (uint32_t)WS2812_Front, (uint32_t)&GPIOA->ODR, WS2812_Length*PIXEL_SLOTS);
+#endif
+   DMA_SetConfiguration(&DMA_HandleStruct_CC2, (uint32_t)&WS2812_Low, (uint32_t)&GPIOA->ODR, WS2812_Length*PIXEL_SLOTS + RESET_SLOTS);
    
    // clear all relevant DMA flags from the channels 2,5 and 7
    __HAL_DMA_CLEAR_FLAG(&DMA_HandleStruct_UEV, DMA_FLAG_TC2 | DMA_FLAG_HT2 | DMA_FLAG_TE2 | DMA_FLAG_GL2);
@@ -280,6 +977,9 @@ void WS2812B_sendBuffer( void )
 
    // Enable the selected DMA transfer interrupts
    __HAL_DMA_ENABLE_IT(&DMA_HandleStruct_CC2, (DMA_IT_TC | DMA_IT_HT | DMA_IT_TE));
+#if( WS2812B_STREAMING == 1u )
+   __HAL_DMA_ENABLE_IT(&DMA_HandleStruct_CC1, (DMA_IT_TC | DMA_IT_HT | DMA_IT_TE));
+#endif
    
    // enable dma channels
    __HAL_DMA_ENABLE(&DMA_HandleStruct_UEV);
@@ -298,8 +998,8 @@ void WS2812B_sendBuffer( void )
    TIM_CCxChannelCmd(TIM2, TIM_CHANNEL_1, TIM_CCx_ENABLE);
    TIM_CCxChannelCmd(TIM2, TIM_CHANNEL_2, TIM_CCx_ENABLE);
    
-   // preload counter with 29 so TIM2 generates UEV directly to start DMA transfer
-   __HAL_TIM_SET_COUNTER(&TIM2_Handle, 29);
+   // preload counter with the last tick of the period so TIM2 generates UEV directly to start DMA transfer
+   __HAL_TIM_SET_COUNTER(&TIM2_Handle, TICKS_PERIOD-1u);
    
    // start TIM2
    __HAL_TIM_ENABLE(&TIM2_Handle);
@@ -307,7 +1007,8 @@ void WS2812B_sendBuffer( void )
 
 // ----------------------------------------------------------------------------
 /// \brief      DMA1 Channe7 Interrupt Handler gets executed once the complete 
-///             frame buffer has been transmitted to the LEDs.
+///             frame buffer and the reset period have been transmitted to the
+///             LEDs.
 ///
 /// \param      none
 ///
@@ -317,38 +1018,68 @@ void DMA1_Channel7_IRQHandler( void )
    HAL_DMA_IRQHandler(&DMA_HandleStruct_CC2);
 }
 
+#if( WS2812B_STREAMING == 1u )
 // ----------------------------------------------------------------------------
-/// \brief      Timer 2 interrupt handler.
+/// \brief      DMA1 Channel5 Interrupt Handler gets executed each time one
+///             half of the ring has been transmitted to the LEDs.
 ///
 /// \param      none
 ///
 /// \return     none
-void TIM2_IRQHandler( void )
+void DMA1_Channel5_IRQHandler( void )
 {
-   WS2812_TIM2_callback();
+   HAL_DMA_IRQHandler(&DMA_HandleStruct_CC1);
 }
 
 // ----------------------------------------------------------------------------
-/// \brief      Used to wait, until deadtime/reset period is finished, thus
-///             the leds have accepted their values.
+/// \brief      DMA half transfer callback of the ring, the first half has
+///             been transmitted and is refilled with the next pixels.
 ///
-/// \param      none
+/// \param      [in]    pointer to a DMA_HandleTypeDef structure that contains
+///                     the configuration information for the specified DMA Stream.
 ///
 /// \return     none
-static void WS2812_TIM2_callback( void )
+static void StreamHalfComplete( DMA_HandleTypeDef *DmaHandle )
 {
-   // Clear TIM2 Interrupt Flag
-   HAL_NVIC_ClearPendingIRQ(TIM2_IRQn);
-   
-   // stop TIM2 now because dead period has been reached
-   __HAL_TIM_DISABLE(&TIM2_Handle);
-   
-   // disable the TIM2 Update interrupt again so it doesn't occur while transmitting data
-   __HAL_TIM_DISABLE_IT(&TIM2_Handle, TIM_IT_UPDATE);
-   
-   // finally indicate that the data frame has been transmitted
-   WS2812_State = WS2812B_READY;
+   stream_fill( &WS2812_Buffer[0] );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      DMA transfer complete callback of the ring, the second half
+///             has been transmitted and is refilled with the next pixels.
+///
+/// \param      [in]    pointer to a DMA_HandleTypeDef structure that contains
+///                     the configuration information for the specified DMA Stream.
+///
+/// \return     none
+static void StreamComplete( DMA_HandleTypeDef *DmaHandle )
+{
+   stream_fill( &WS2812_Buffer[GPIO_BUFFERSIZE/2u] );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Encodes the next WS2812B_STREAM_PIXELS pixel columns into one
+///             half of the ring.
+///
+/// \param      [in]    first slot of the ring half
+///
+/// \return     none
+static void stream_fill( uint16_t *slots )
+{
+   for( uint16_t i = 0; i < WS2812B_STREAM_PIXELS; i++ )
+   {
+      // columns behind the last pixel keep the data line low through the reset period
+      if( WS2812_StreamCol >= WS2812_StreamEnd )
+      {
+         memset( &slots[i*PIXEL_SLOTS], 0, PIXEL_SLOTS*sizeof(uint16_t) );
+         continue;
+      }
+      
+      encode_column( &slots[i*PIXEL_SLOTS], &WS2812_Source[0][WS2812_StreamCol*WS2812B_LED_BYTES], FRAME_BYTES );
+      WS2812_StreamCol++;
+   }
 }
+#endif
 
 // ----------------------------------------------------------------------------
 /// \brief      Sets the DMA Transfer parameter.
@@ -389,7 +1120,8 @@ static void DMA_SetConfiguration( DMA_HandleTypeDef *hdma, uint32_t SrcAddress,
 }
 
 // ----------------------------------------------------------------------------
-/// \brief      DMA conversion complete callback.
+/// \brief      DMA conversion complete callback. The low slots of the
+///             reset period have been sent, the leds have latched the frame.
 ///
 /// \param      [in]    pointer to a DMA_HandleTypeDef structure that contains
 ///                     the configuration information for the specified DMA Stream.
@@ -399,6 +1131,13 @@ static void TransferComplete( DMA_HandleTypeDef *DmaHandle )
 {
    // clear DMA7 transfer complete interrupt flag
    HAL_NVIC_ClearPendingIRQ(DMA1_Channel7_IRQn);
+   CYCLES_STOP( CYCLES_TRANSFER );
+   
+#if( WS2812B_STREAMING == 1u )
+   // stop refilling the ring
+   __HAL_DMA_DISABLE_IT(&DMA_HandleStruct_CC1, (DMA_IT_TC | DMA_IT_HT | DMA_IT_TE));
+   HAL_NVIC_ClearPendingIRQ(DMA1_Channel5_IRQn);
+#endif
    
    // disable the DMA channels
    __HAL_DMA_DISABLE(&DMA_HandleStruct_UEV);
@@ -414,12 +1153,31 @@ static void TransferComplete( DMA_HandleTypeDef *DmaHandle )
    TIM_CCxChannelCmd(TIM2, TIM_CHANNEL_1, TIM_CCx_DISABLE);
    TIM_CCxChannelCmd(TIM2, TIM_CHANNEL_2, TIM_CCx_DISABLE);
    
-   // enable TIM2 Update interrupt to append min. 50us dead/reset period
-   TIM2->ARR = 1500u; // 1 tick = 41.67ns => 1500 ticks = ~60us
-   TIM2->CNT = 0u;
-   __HAL_TIM_ENABLE_IT(&TIM2_Handle, TIM_IT_UPDATE);
-}
-
+   // stop TIM2
+   __HAL_TIM_DISABLE(&TIM2_Handle);
+   
+   WS2812B_CallbackTypeDef callback = WS2812_Callback;
+   
+   // send the queued back buffer right away or indicate that the data frame has been transmitted
+   if( WS2812_Pending != false )
+   {
+      WS2812_Pending = false;
+      WS2812_Callback = WS2812_CallbackPending;
+      swap_buffers();
+      start_transfer();
+   }
+   else
+   {
+      WS2812_State = WS2812B_READY;
+   }
+   
+   // report the latched frame
+   if( callback != NULL )
+   {
+      callback();
+   }
+}
+
 // ----------------------------------------------------------------------------
 /// \brief      DMA transfer error callback.
 ///
@@ -443,16 +1201,275 @@ static void TransferError( DMA_HandleTypeDef *DmaHandle )
 /// \return     none
 void WS2812B_clearBuffer( void )
 {
-   // wait until last buffer transmission has been completed
-   while( WS2812_State != WS2812B_READY );
-  
-   // clear frame buffer
-   for(uint8_t y=0; y<ROW;y++)
+   CYCLES_START( CYCLES_CLEAR );
+   
+   // clear rgb frame
+   WS2812B_fillAll( 0x00, 0x00, 0x00 );
+   
+   CYCLES_STOP( CYCLES_CLEAR );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Sets pixels col_start..col_end of one stripe to one color.
+///
+/// \param      [in]    uint8_t row
+/// \param      [in]    uint16_t col_start
+/// \param      [in]    uint16_t col_end, inclusive
+/// \param      [in]    uint8_t red
+/// \param      [in]    uint8_t green
+/// \param      [in]    uint8_t blue
+///
+/// \return     none
+void WS2812B_fillSpan( uint8_t row, uint16_t col_start, uint16_t col_end, uint8_t red, uint8_t green, uint8_t blue )
+{
+   WS2812B_fillRect( row, col_start, row, col_end, red, green, blue );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Sets all pixels to one color.
+///
+/// \param      [in]    uint8_t red
+/// \param      [in]    uint8_t green
+/// \param      [in]    uint8_t blue
+///
+/// \return     none
+void WS2812B_fillAll( uint8_t red, uint8_t green, uint8_t blue )
+{
+   WS2812B_fillRect( 0u, 0u, ROW-1u, COL-1u, red, green, blue );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sets the global brightness. The brightness scales the color
+///            values before the gamma curve, so dimming is perceptually even.
+///            The color table is rebuilt once here, the encoders only look
+///            up the values. The whole frame is sent again on the next send.
+///            With WS2812B_POWER_LIMIT the frames may be sent darker while
+///            they exceed the power budget.
+///
+/// \param     [in] uint8_t brightness, 0..255
+///
+/// \return    none
+void WS2812B_setBrightness( uint8_t brightness )
+{
+   WS2812_Brightness = brightness;
+   build_lut( brightness );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Builds the color table for a brightness and marks the whole
+///            frame for sending.
+///
+/// \param     [in] uint8_t brightness, 0..255
+///
+/// \return    none
+static void build_lut( uint8_t brightness )
+{
+#if( WS2812B_STREAMING == 1u )
+   // the frame on the wire is encoded with the table on the fly
+   wait_back_buffer();
+   CYCLES_START( CYCLES_WAIT );
+   WAIT_WHILE( WS2812_State == WS2812B_BUSY );
+   CYCLES_STOP( CYCLES_WAIT );
+#endif
+   
+#if( WS2812B_DITHER == 1u )
+   // the scaled node falls between two nodes of the curve, interpolate
+   for( uint16_t i = 0; i <= 256u; i++ )
    {
-      for(uint16_t x=0; x<COL; x++)
+      uint32_t scaled   = ((uint32_t)i*256u*brightness + 127u)/255u;
+      uint16_t node     = (uint16_t)(scaled >> 8u);
+      
+      if( node >= 256u )
       {
-         WS2812B_setPixel(y, x, 0x00, 0x00, 0x00);
+         WS2812_Lut[i] = WS2812_Gamma[256];
+         continue;
       }
+      
+      WS2812_Lut[i] = (uint16_t)(WS2812_Gamma[node] + (((uint32_t)(WS2812_Gamma[node+1u] - WS2812_Gamma[node])*(scaled & 0xFFu)) >> 8u));
+   }
+#else
+   for( uint16_t i = 0; i < 256u; i++ )
+   {
+      WS2812_Lut[i] = WS2812_Gamma[(i*brightness + 127u)/255u];
+   }
+#endif
+   
+   WS2812_LutBrightness = brightness;
+   
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      mark_dirty( row, 0u, COL-1u );
+   }
+}
+
+#if( WS2812B_POWER_LIMIT == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Estimated current of the frame as it is sent, quiescent current
+///            included.
+///
+/// \param     none
+///
+/// \return    uint32_t current in mA
+uint32_t WS2812B_getCurrent( void )
+{
+   return estimate_current( WS2812_LutBrightness );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Updates the color sum with a pixel which is overwritten.
+///
+/// \param     [in] WS2812_Color_t *pixel, old wire bytes
+/// \param     [in] WS2812_Color_t *wire, new wire bytes
+/// \param     [in] uint8_t bytes, of the led
+///
+/// \return    none
+static void account_pixel( const WS2812_Color_t *pixel, const WS2812_Color_t *wire, uint8_t bytes )
+{
+   for( uint8_t i = 0; i < bytes; i++ )
+   {
+      WS2812_Power += (uint32_t)POWER(wire[i]) - (uint32_t)POWER(pixel[i]);
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Estimates the current of the frame at a brightness. The
+///            brightness scales the colors before the gamma curve, so the
+///            power at full brightness is scaled by the curve value of the
+///            brightness.
+///
+/// \param     [in] uint8_t brightness
+///
+/// \return    uint32_t current in mA
+static uint32_t estimate_current( uint8_t brightness )
+{
+   // current at full brightness, then scaled by the curve
+   uint32_t sum = (WS2812_Power*WS2812B_CHANNEL_MA)/255u;
+   
+   return ROW*COL*WS2812B_IDLE_MA + (sum*POWER(COLOR(brightness)))/255u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Highest brightness up to the one set by the application at
+///            which the frame stays within the power budget, binary search
+///            over the 256 brightness steps.
+///
+/// \param     none
+///
+/// \return    uint8_t brightness
+static uint8_t limit_brightness( void )
+{
+   uint8_t low    = 0u;
+   uint8_t high   = WS2812_Brightness;
+   
+   if( estimate_current( high ) <= WS2812B_POWER_BUDGET_MA )
+   {
+      return high;
+   }
+   
+   // the current at low is within the budget or low is 0, the current at high exceeds it
+   while( (uint8_t)(high - low) > 1u )
+   {
+      uint8_t middle = low + (high - low)/2u;
+      
+      if( estimate_current( middle ) <= WS2812B_POWER_BUDGET_MA )
+      {
+         low = middle;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+   
+   return low;
+}
+#endif
+
+#if( CYCLES_ENABLE == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Core cycles the last WS2812B_sendBuffer spent encoding the
+///            frame. Always 0 in streaming mode, where the frame is encoded
+///            by the dma interrupts.
+///
+/// \param     none
+///
+/// \return    uint32_t cycles
+uint32_t WS2812B_getEncodeCycles( void )
+{
+   return Cycles_Stats[CYCLES_ENCODE].last;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief      Sets the pixels col_start..col_end of the stripes
+///             row_start..row_end to one color. The rectangle is clipped to
+///             the matrice.
+///
+/// \param      [in]    uint8_t row_start
+/// \param      [in]    uint16_t col_start
+/// \param      [in]    uint8_t row_end, inclusive
+/// \param      [in]    uint16_t col_end, inclusive
+/// \param      [in]    uint8_t red
+/// \param      [in]    uint8_t green
+/// \param      [in]    uint8_t blue
+///
+/// \return     none
+void WS2812B_fillRect( uint8_t row_start, uint16_t col_start, uint8_t row_end, uint16_t col_end, uint8_t red, uint8_t green, uint8_t blue )
+{
+   // check if the rectangle is valid and clip it
+   if( row_start > row_end || col_start > col_end || row_start >= ROW || col_start >= COL )
+   {
+      return;
+   }
+   
+   if( row_end >= ROW )
+   {
+      row_end = ROW-1u;
+   }
+   
+   if( col_end >= COL )
+   {
+      col_end = COL-1u;
+   }
+   
+   // wait until the rgb frame may be written
+   wait_frame();
+   
+   const WS2812_Color_t color[4] = { COLOR(red), COLOR(green), COLOR(blue), 0u };
+   
+   // store the changed pixels in the rgb frame
+   for( uint8_t row = row_start; row <= row_end; row++ )
+   {
+      fill_span( row, col_start, col_end-col_start+1u, color );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Sets all pixels of a zone to one color. The spans of a zone
+///             are resolved to physical pixels and checked by WS2812B_SPAN
+///             at compile time, at runtime only with USE_FULL_ASSERT.
+///
+/// \param      [in]    WS2812B_ZoneTypeDef *zone
+/// \param      [in]    uint8_t red
+/// \param      [in]    uint8_t green
+/// \param      [in]    uint8_t blue
+///
+/// \return     none
+void WS2812B_fillZone( const WS2812B_ZoneTypeDef *zone, uint8_t red, uint8_t green, uint8_t blue )
+{
+   // wait until the rgb frame may be written
+   wait_frame();
+   
+   const WS2812_Color_t color[4] = { COLOR(red), COLOR(green), COLOR(blue), 0u };
+   
+   for( uint16_t span = 0u; span < zone->count; span++ )
+   {
+      const WS2812B_SpanTypeDef *s = &zone->spans[span];
+      
+      // WS2812B_SPAN has checked the span while compiling, only hand made ones can be wrong
+      assert_param( s->row < ROW && s->count != 0u && s->col + s->count <= COL );
+      
+      fill_span( s->row, s->col, s->count, color );
    }
 }
 
@@ -474,20 +1491,497 @@ void WS2812B_setPixel( uint8_t row, uint16_t col, uint8_t red, uint8_t green, ui
       return;
    }
    
-   // wait until last buffer transmission has been completed
-   while( WS2812_State != WS2812B_READY );
+   // wait until the rgb frame may be written
+   wait_frame();
+   
+   // store the pixel in the rgb frame, it is encoded on sending
+   const WS2812_Color_t color[4] = { COLOR(red), COLOR(green), COLOR(blue), 0u };
    
-   // write pixel into the buffer
-   for( uint8_t i = 0; i < 8; i++ )
+   store_pixel( row, col, color );
+}
+
+#if( WS2812B_LED_BYTES == 4u )
+// ----------------------------------------------------------------------------
+/// \brief     Sets the color of a rgbw pixel.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col
+/// \param     [in] uint8_t red
+/// \param     [in] uint8_t green
+/// \param     [in] uint8_t blue
+/// \param     [in] uint8_t white
+///
+/// \return    none
+void WS2812B_setPixelRGBW( uint8_t row, uint16_t col, uint8_t red, uint8_t green, uint8_t blue, uint8_t white )
+{
+   // check if the col and row are valid
+   if( row >= ROW || col >= COL )
    {
-      /* clear the data for pixel */
-      WS2812_Buffer[((col*24)+i)] &= ~(0x01<<row);
-      WS2812_Buffer[((col*24)+8+i)] &= ~(0x01<<row);
-      WS2812_Buffer[((col*24)+16+i)] &= ~(0x01<<row);
+      return;
+   }
+   
+   // wait until the rgb frame may be written
+   wait_frame();
+   
+   const WS2812_Color_t color[4] = { COLOR(red), COLOR(green), COLOR(blue), COLOR(white) };
+   
+   store_pixel( row, col, color );
+}
+#endif
+
+#if( WS2812B_DITHER == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Sets the 16 bit color of a pixel, the fraction below 8 bit is
+///            shown by dithering over the frames.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col
+/// \param     [in] uint16_t red
+/// \param     [in] uint16_t green
+/// \param     [in] uint16_t blue
+///
+/// \return    none
+void WS2812B_setPixel16( uint8_t row, uint16_t col, uint16_t red, uint16_t green, uint16_t blue )
+{
+   // check if the col and row are valid
+   if( row >= ROW || col >= COL )
+   {
+      return;
+   }
+   
+   // wait until the rgb frame may be written
+   wait_frame();
+   
+   const WS2812_Color_t color[4] = { red, green, blue, 0u };
+   
+   store_pixel( row, col, color );
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Stores a pixel in the rgb frame if it has changed.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col
+/// \param     [in] WS2812_Color_t *color, red, green, blue and white
+///
+/// \return    none
+static void store_pixel( uint8_t row, uint16_t col, const WS2812_Color_t *color )
+{
+   fill_span( row, col, 1u, color );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Stores count pixels of a stripe starting at col_start in the
+///            rgb frame and marks the changed ones dirty.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col_start
+/// \param     [in] uint16_t count, col_start+count must not exceed COL
+/// \param     [in] WS2812_Color_t *color, red, green, blue and white
+///
+/// \return    none
+static void fill_span( uint8_t row, uint16_t col_start, uint16_t count, const WS2812_Color_t *color )
+{
+   const uint8_t  bytes          = WS2812_Bytes[row];
+   WS2812_Color_t *pixel         = &WS2812_Frame[row][col_start*bytes];
+   WS2812_Color_t wire[4];
+   uint16_t       changed_start  = COL;
+   uint16_t       changed_end    = 0u;
+   uint8_t        i;
+   
+   // the frame holds the colors in the wire order of the stripe, the white of rgb leds is dropped
+   for( i = 0u; i < bytes; i++ )
+   {
+      wire[i] = color[WS2812_Order[row][i]];
+   }
+   
+   for( uint16_t col = col_start; col < col_start+count; col++, pixel += bytes )
+   {
+      // skip the bytes which already have the color
+      for( i = 0u; i < bytes && pixel[i] == wire[i]; i++ );
+      
+      if( i < bytes )
+      {
+#if( WS2812B_POWER_LIMIT == 1u )
+         account_pixel( pixel, wire, bytes );
+#endif
+         for( ; i < bytes; i++ )
+         {
+            pixel[i] = wire[i];
+         }
+         
+         if( changed_start == COL )
+         {
+            changed_start = col;
+         }
+         changed_end = col;
+      }
+   }
+   
+   if( changed_start != COL )
+   {
+      mark_dirty( row, changed_start, changed_end );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      This function reads back the color of a single pixel from
+///             the rgb frame.
+///
+/// \param      [in]    uint8_t row
+/// \param      [in]    uint16_t col
+/// \param      [out]   uint8_t *red
+/// \param      [out]   uint8_t *green
+/// \param      [out]   uint8_t *blue
+///
+/// \return     WS2812B_StatusTypeDef
+WS2812B_StatusTypeDef WS2812B_getPixel( uint8_t row, uint16_t col, uint8_t *red, uint8_t *green, uint8_t *blue )
+{
+   WS2812_Color_t color[4];
+   
+   // check if the col and row are valid
+   if( row >= ROW || col >= COL )
+   {
+      return WS2812B_ERROR;
+   }
+   
+   load_pixel( row, col, color );
+   
+   *red     = COLOR_8(color[0]);
+   *green   = COLOR_8(color[1]);
+   *blue    = COLOR_8(color[2]);
+   
+   return WS2812B_OK;
+}
+
+#if( WS2812B_LED_BYTES == 4u )
+// ----------------------------------------------------------------------------
+/// \brief      Reads back the color of a rgbw pixel from the rgb frame, the
+///             white of a led on a rgb stripe is 0.
+///
+/// \param      [in]    uint8_t row
+/// \param      [in]    uint16_t col
+/// \param      [out]   uint8_t *red
+/// \param      [out]   uint8_t *green
+/// \param      [out]   uint8_t *blue
+/// \param      [out]   uint8_t *white
+///
+/// \return     WS2812B_StatusTypeDef
+WS2812B_StatusTypeDef WS2812B_getPixelRGBW( uint8_t row, uint16_t col, uint8_t *red, uint8_t *green, uint8_t *blue, uint8_t *white )
+{
+   WS2812_Color_t color[4];
+   
+   // check if the col and row are valid
+   if( row >= ROW || col >= COL )
+   {
+      return WS2812B_ERROR;
+   }
+   
+   load_pixel( row, col, color );
+   
+   *red     = COLOR_8(color[0]);
+   *green   = COLOR_8(color[1]);
+   *blue    = COLOR_8(color[2]);
+   *white   = COLOR_8(color[3]);
+   
+   return WS2812B_OK;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Loads a pixel of the rgb frame back into the channel order.
+///
+/// \param     [in]  uint8_t row
+/// \param     [in]  uint16_t col
+/// \param     [out] WS2812_Color_t *color, red, green, blue and white, white
+///            is 0 on a rgb stripe
+///
+/// \return    none
+static void load_pixel( uint8_t row, uint16_t col, WS2812_Color_t *color )
+{
+   const uint8_t        bytes = WS2812_Bytes[row];
+   const WS2812_Color_t *pixel = &WS2812_Frame[row][col*bytes];
+   
+   color[3] = 0u;
+   for( uint8_t i = 0; i < bytes; i++ )
+   {
+      color[WS2812_Order[row][i]] = pixel[i];
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      This function sets the colors of one pixel column of all
+///             stripes.
+///
+/// \param      [in]    uint16_t col
+/// \param      [in]    ROW rgb triplets (red, green, blue), stripe 0 first
+///
+/// \return     none
+void WS2812B_setColumn( uint16_t col, const uint8_t *rgb )
+{
+   // check if the col is valid
+   if( col >= COL )
+   {
+      return;
+   }
+   
+   // wait until the rgb frame may be written
+   wait_frame();
+   
+   // store the changed pixels in the rgb frame
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      const WS2812_Color_t color[4] = { COLOR(rgb[row*3u]), COLOR(rgb[row*3u+1u]), COLOR(rgb[row*3u+2u]), 0u };
+      
+      store_pixel( row, col, color );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Encodes the bit slots (color bytes in wire order of each
+///             stripe, msb first) of one pixel column of all stripes, one bit
+///             per stripe and slot. Reference encoder with one shift and mask
+///             per bit and stripe.
+///
+/// \param      [out]   first of the bit slots
+/// \param      [in]    wire bytes of the column of stripe 0
+/// \param      [in]    distance in bytes between the columns of two stripes
+///
+/// \return     none
+static void encode_column_shiftmask( uint16_t *slots, const uint8_t *pixel, uint16_t stride )
+{
+   memset( slots, 0, PIXEL_SLOTS*sizeof(uint16_t) );
+   
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint8_t byte = 0; byte < WS2812B_LED_BYTES; byte++ )
+      {
+         uint8_t color = CORRECT(pixel[row*stride+byte]);
+         
+         for( uint8_t i = 0; i < 8; i++ )
+         {
+            slots[byte*8u+i] |= ((((color<<i) & 0x80)>>7)<<row);
+         }
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Encodes the bit slots (color bytes in wire order of each
+///             stripe, msb first) of one pixel column of all stripes, one bit
+///             per stripe and slot. Each color byte is encoded with a bit
+///             matrix transpose.
+///
+/// \param      [out]   first of the bit slots
+/// \param      [in]    wire bytes of the column of stripe 0
+/// \param      [in]    distance in bytes between the columns of two stripes
+///
+/// \return     none
+static void encode_column_transpose( uint16_t *slots, const uint8_t *pixel, uint16_t stride )
+{
+   for( uint8_t byte = 0; byte < WS2812B_LED_BYTES; byte++ )
+   {
+      transpose_byte( &slots[byte*8u], pixel, byte, stride );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Transposes one wire byte of each stripe into 8 bit slots:
+///             bit 7-i of the byte of stripe n becomes bit n of slot i. The
+///             bytes of 8 stripes are packed into two words and transposed
+///             as 8x8 bit matrix in registers (Hacker's Delight, transpose8).
+///
+/// \param      [out]   first of the 8 bit slots
+/// \param      [in]    wire bytes of the column of stripe 0
+/// \param      [in]    wire byte in the column
+/// \param      [in]    distance in bytes between the columns of two stripes
+///
+/// \return     none
+static void transpose_byte( uint16_t *slots, const uint8_t *pixel, uint8_t byte, uint16_t stride )
+{
+   uint32_t word[4] = { 0u, 0u, 0u, 0u };   // byte n of word m = stripe 4*m+n
+   uint32_t x;
+   uint32_t y;
+   uint32_t t;
+   
+   // gather the color corrected bytes of all stripes, unused stripes stay 0
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      word[row>>2u] |= (uint32_t)CORRECT(pixel[row*stride+byte]) << ((row & 3u)*8u);
+   }
+   
+   for( uint8_t group = 0; group < ((ROW+7u)/8u); group++ )
+   {
+      // stripes 7..4 in x, stripes 3..0 in y, msb first
+      x = word[group*2u+1u];
+      y = word[group*2u];
+      
+      t = (x ^ (x >> 7)) & 0x00AA00AAu;   x = x ^ t ^ (t << 7);
+      t = (y ^ (y >> 7)) & 0x00AA00AAu;   y = y ^ t ^ (t << 7);
+      t = (x ^ (x >> 14)) & 0x0000CCCCu;  x = x ^ t ^ (t << 14);
+      t = (y ^ (y >> 14)) & 0x0000CCCCu;  y = y ^ t ^ (t << 14);
+      t = (x & 0xF0F0F0F0u) | ((y >> 4) & 0x0F0F0F0Fu);
+      y = ((x << 4) & 0xF0F0F0F0u) | (y & 0x0F0F0F0Fu);
+      x = t;
+      
+      // the 8 stripes of this group go into byte lane <group> of the slots
+      if( group == 0u )
+      {
+         slots[0] = (uint16_t)(x >> 24);
+         slots[1] = (uint16_t)((x >> 16) & 0xFFu);
+         slots[2] = (uint16_t)((x >> 8) & 0xFFu);
+         slots[3] = (uint16_t)(x & 0xFFu);
+         slots[4] = (uint16_t)(y >> 24);
+         slots[5] = (uint16_t)((y >> 16) & 0xFFu);
+         slots[6] = (uint16_t)((y >> 8) & 0xFFu);
+         slots[7] = (uint16_t)(y & 0xFFu);
+      }
+      else
+      {
+         slots[0] |= (uint16_t)((x >> 24) << 8);
+         slots[1] |= (uint16_t)(((x >> 16) & 0xFFu) << 8);
+         slots[2] |= (uint16_t)(((x >> 8) & 0xFFu) << 8);
+         slots[3] |= (uint16_t)((x & 0xFFu) << 8);
+         slots[4] |= (uint16_t)((y >> 24) << 8);
+         slots[5] |= (uint16_t)(((y >> 16) & 0xFFu) << 8);
+         slots[6] |= (uint16_t)(((y >> 8) & 0xFFu) << 8);
+         slots[7] |= (uint16_t)((y & 0xFFu) << 8);
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief      Encodes the bit slots (color bytes in wire order, msb first)
+///             of one pixel column of a single stripe with a read-modify-write
+///             per slot.
+///
+/// \param      [in/out]    first of the bit slots
+/// \param      [in]        stripe
+/// \param      [in]        wire bytes of the pixel
+///
+/// \return     none
+static void encode_pixel_shiftmask( uint16_t *slots, uint8_t row, const uint8_t *pixel )
+{
+   for( uint8_t byte = 0; byte < WS2812B_LED_BYTES; byte++ )
+   {
+      uint8_t color = CORRECT(pixel[byte]);
+      
+      for( uint8_t i = 0; i < 8; i++ )
+      {
+         /* clear the data for pixel */
+         slots[byte*8u+i] &= ~(0x01<<row);
+         
+         /* write new data for pixel */
+         slots[byte*8u+i] |= ((((color<<i) & 0x80)>>7)<<row);
+      }
+   }
+}
+
+#if( WS2812B_BITBAND == 1u )
+// ----------------------------------------------------------------------------
+/// \brief      Encodes the bit slots (color bytes in wire order, msb first)
+///             of one pixel column of a single stripe. Every stripe bit is
+///             written with a single store through the sram bit-band alias, no
+///             read and no branch. Consecutive halfword slots are 16 alias
+///             words apart.
+///
+/// \param      [in/out]    first of the bit slots, must be located in sram
+/// \param      [in]        stripe
+/// \param      [in]        wire bytes of the pixel
+///
+/// \return     none
+static void encode_pixel_bitband( uint16_t *slots, uint8_t row, const uint8_t *pixel )
+{
+   volatile uint32_t *bit = BITBAND_SRAM( slots, row );
+   
+   for( uint8_t byte = 0; byte < WS2812B_LED_BYTES; byte++ )
+   {
+      uint8_t color = CORRECT(pixel[byte]);
       
-      /* write new data for pixel */
-      WS2812_Buffer[((col*24)+i)] |= ((((green<<i) & 0x80)>>7)<<row);
-      WS2812_Buffer[((col*24)+8+i)] |= ((((red<<i) & 0x80)>>7)<<row);
-      WS2812_Buffer[((col*24)+16+i)] |= ((((blue<<i) & 0x80)>>7)<<row);
+      for( uint8_t i = 0; i < 8; i++ )
+      {
+         bit[(byte*8u+i)*16u] = (uint32_t)(color >> (7u-i)) & 1u;
+      }
    }
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief      Encoder test. The transpose encoder and the single pixel
+///             encoders must produce the same bit slots as the shift and mask
+///             reference encoder. Must run after WS2812B_init, which builds
+///             the color table used by all encoders. The bit-band encoder
+///             can only be checked on the target, the cycles of both column
+///             and both pixel encoders go into the Cycles statistics. The waveform on the
+///             wire is decoded by the host test in Test/Host.
+///
+/// \param      none
+///
+/// \return     WS2812B_StatusTypeDef
+WS2812B_StatusTypeDef WS2812B_test( void )
+{
+   uint8_t  rgb[ROW][WS2812B_LED_BYTES];
+   uint16_t slots_reference[PIXEL_SLOTS];
+   uint16_t slots_transpose[PIXEL_SLOTS];
+   uint16_t slots_pixel[PIXEL_SLOTS] = { 0u };   // the pixel encoders leave the bits of the other stripes, ROW..15 stay zero like in the column encoders
+#if( WS2812B_BITBAND == 1u )
+   uint16_t slots_bitband[PIXEL_SLOTS] = { 0u };
+#endif
+   uint32_t random = 0x12345678u;
+   
+   for( uint16_t i = 0; i < 256u; i++ )
+   {
+      // fill the column with pseudo random colors, the first column is black
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         for( uint8_t color = 0; color < WS2812B_LED_BYTES; color++ )
+         {
+            random = random*1664525u + 1013904223u;
+            rgb[row][color] = (i == 0u) ? 0u : (uint8_t)(random >> 24);
+         }
+      }
+      
+      CYCLES_START( CYCLES_COLUMN_SHIFTMASK );
+      encode_column_shiftmask( slots_reference, &rgb[0][0], WS2812B_LED_BYTES );
+      CYCLES_STOP( CYCLES_COLUMN_SHIFTMASK );
+      
+      CYCLES_START( CYCLES_COLUMN_TRANSPOSE );
+      encode_column_transpose( slots_transpose, &rgb[0][0], WS2812B_LED_BYTES );
+      CYCLES_STOP( CYCLES_COLUMN_TRANSPOSE );
+      
+      if( memcmp( slots_reference, slots_transpose, sizeof(slots_reference) ) != 0 )
+      {
+         return WS2812B_ERROR;
+      }
+      
+      // overwrite the slots of the previous column pixel by pixel
+      CYCLES_START( CYCLES_PIXEL_SHIFTMASK );
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         encode_pixel_shiftmask( slots_pixel, row, rgb[row] );
+      }
+      CYCLES_STOP( CYCLES_PIXEL_SHIFTMASK );
+      
+      if( memcmp( slots_reference, slots_pixel, sizeof(slots_reference) ) != 0 )
+      {
+         return WS2812B_ERROR;
+      }
+      
+#if( WS2812B_BITBAND == 1u )
+      CYCLES_START( CYCLES_PIXEL_BITBAND );
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         encode_pixel_bitband( slots_bitband, row, rgb[row] );
+      }
+      CYCLES_STOP( CYCLES_PIXEL_BITBAND );
+      
+      if( memcmp( slots_reference, slots_bitband, sizeof(slots_reference) ) != 0 )
+      {
+         return WS2812B_ERROR;
+      }
+#endif
+   }
+   
+   return WS2812B_OK;
 }
\ No newline at end of file
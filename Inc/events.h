@@ -52,6 +52,7 @@
 #define EVENT_BUTTON_IGNITION    ( 1u )
 #define EVENT_BUTTON_LEFT        ( 2u )
 #define EVENT_BUTTON_RIGHT       ( 3u )
+#define EVENT_FRAME_SENT         ( 4u )
 
 // Exported types *************************************************************
 
@@ -0,0 +1,90 @@
+// ****************************************************************************
+/// \file      power.h
+///
+/// \brief     Power Header File
+///
+/// \details   Parking of the bulli in stop mode
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+/// 
+/// \copyright Copyright (c) 2026 Nico Korn
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _POWER_H
+#define _POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include "stm32f1xx_hal.h"
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Private defines -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+   Power_OK    = 0x00U,
+   Power_BUSY  = 0x01U,
+   Power_ERROR = 0x02U
+}Power_StatusTypeDef;
+
+typedef enum
+{
+   Power_CLOCK_FULL  = 0x00U,    // 72 MHz, hse 8 MHz x 9
+   Power_CLOCK_ECO   = 0x01U     // 24 MHz, hse 8 MHz x 3
+}Power_ClockTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+Power_StatusTypeDef  Power_initClock ( void );
+Power_StatusTypeDef  Power_stop      ( bool (*isIdle)(void) );
+Power_StatusTypeDef  Power_setClock  ( Power_ClockTypeDef clock );
+Power_ClockTypeDef   Power_getClock  ( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _POWER_H */
+
+/************************ (C) COPYRIGHT Nico Korn ***************END OF FILE****/
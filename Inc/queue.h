@@ -50,6 +50,7 @@ extern "C" {
 #endif
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
 #include "stm32f1xx_hal.h"
 
 /* Private includes ----------------------------------------------------------*/
@@ -57,19 +58,20 @@ extern "C" {
 /* Private defines -----------------------------------------------------------*/
 
 /* Exported types ------------------------------------------------------------*/
+// single producer, single consumer ring: tail is only written by the producer,
+// head only by the consumer, both run free and are masked on access
 typedef struct
 {
-	uint8_t*	array;
-   uint16_t	capacity;
-	uint16_t	size;
-	uint16_t	head;
-	uint16_t	tail;
+	uint8_t* const	   array;
+   uint16_t	         capacity;      // power of two
+   uint16_t	         mask;
+	volatile uint16_t	head;
+	volatile uint16_t	tail;
 }Queue_t;
 
 typedef enum
 {
    QUEUE_OK             = 0x00U,
-   QUEUE_ERR_NOMEM      = 0x01U,
    QUEUE_ERR_PARAM      = 0x02U,
    QUEUE_ERR_NPSPC      = 0x03U,
    QUEUE_ERR_EMPTY      = 0x04U,
@@ -79,12 +81,18 @@ typedef enum
 /* Exported constants --------------------------------------------------------*/
 
 /* Exported macro ------------------------------------------------------------*/
+// declares a queue with static storage, the capacity must be a power of two
+// up to 32768, otherwise the enum initialiser divides by zero and the
+// compilation fails
+#define QUEUE_DEFINE( name, size )                                                      \
+   enum { name##_capacity_check = 1/( ((size) > 0u && (size) <= 32768u && ((size) & ((size)-1u)) == 0u) ? 1 : 0 ) }; \
+   static uint8_t name##_array[(size)];                                                  \
+   static Queue_t name = { .array = name##_array, .capacity = (size), .mask = (size)-1u, .head = 0u, .tail = 0u }
 
 /* Exported functions prototypes ---------------------------------------------*/
-Queue_StatusTypeDef Queue_init      ( Queue_t *queue, uint16_t capacity );
 Queue_StatusTypeDef Queue_enqueue   ( Queue_t *queue, uint8_t item );
 Queue_StatusTypeDef Queue_dequeue   ( Queue_t *queue, uint8_t *item );
-Queue_StatusTypeDef Queue_kill      ( Queue_t *queue );
+bool                Queue_isEmpty   ( Queue_t *queue );
 Queue_StatusTypeDef Queue_test      ( void );
 
 #ifdef __cplusplus
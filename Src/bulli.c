@@ -45,77 +45,59 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "main.h"
 #include "bulli.h"
 #include "button.h"
 #include "ws2812b.h"
 #include "events.h"
 #include "queue.h"
+#include "cycles.h"
+#include "scheduler.h"
+#include "power.h"
 
 /* Private includes ----------------------------------------------------------*/
 
 /* Private typedef -----------------------------------------------------------*/
-typedef struct
-{
-   uint8_t     row_start;
-   uint16_t    col_start;
-   uint8_t     row_end;
-   uint16_t    col_end;
-}Bulli_light_t;
-
 typedef struct
 {
    bool  ignition_on;
    bool  blink_left;
    bool  blink_right;
+   bool  frame_sending;
+   bool  frame_latched;
 }Bulli_status_t;
 
 /* Private define ------------------------------------------------------------*/
-#define REFRESH_PERIOD_MS        ( 100u )
-#define EVENT_QUEUE_CAPACITY     ( 10u )
+#define BULLI_FPS                ( 50u )     // frames per second, the wire allows up to ~270 for 115 leds
+#define ANIMATION_STEP_MS        ( 100u )    // color wheel and ignition flicker step
+#define BLINK_PERIOD_MS          ( 2000u )
+#define EVENT_QUEUE_CAPACITY     ( 16u )     // power of two
 #define MAX_WHITE                ( 0xAA )
 
+// the button timer and the frame callback both enqueue into the single
+// producer queue, they must not preempt each other
+#if( BUTTON_IRQ_PRIORITY != WS2812B_IRQ_PRIORITY )
+#error "BUTTON_IRQ_PRIORITY and WS2812B_IRQ_PRIORITY must be the same preemption priority"
+#endif
+
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
-static Queue_t eventQueue;
+QUEUE_DEFINE( eventQueue, EVENT_QUEUE_CAPACITY );
 static uint8_t event;
 static Bulli_status_t bulli;
-static const Bulli_light_t bulli_r_blink =
-{
-   .row_start  = 1,
-   .col_start  = 2,
-   .row_end    = 1,
-   .col_end    = 3
-};
-static const Bulli_light_t bulli_l_blink =
-{
-   .row_start  = 1,
-   .col_start  = 4,
-   .row_end    = 1,
-   .col_end    = 5
-};
-static const Bulli_light_t bulli_r_light =
-{
-   .row_start  = 1,
-   .col_start  = 0,
-   .row_end    = 1,
-   .col_end    = 1
-};
-static const Bulli_light_t bulli_l_light =
-{
-   .row_start  = 1,
-   .col_start  = 6,
-   .row_end    = 1,
-   .col_end    = 7
-};
-static const Bulli_light_t bulli_interior_light =
-{
-   .row_start  = 0,
-   .col_start  = 0,
-   .row_end    = 0,
-   .col_end    = COL
-};
-static uint32_t   framecounter;
+static const WS2812B_SpanTypeDef bulli_r_blink_spans[]        = { WS2812B_SPAN( 1u, 2u, 3u ) };
+static const WS2812B_SpanTypeDef bulli_l_blink_spans[]        = { WS2812B_SPAN( 1u, 4u, 5u ) };
+static const WS2812B_SpanTypeDef bulli_r_light_spans[]        = { WS2812B_SPAN( 1u, 0u, 1u ) };
+static const WS2812B_SpanTypeDef bulli_l_light_spans[]        = { WS2812B_SPAN( 1u, 6u, 7u ) };
+static const WS2812B_SpanTypeDef bulli_interior_light_spans[] = { WS2812B_SPAN( 0u, 0u, COL-1u ) };
+static const WS2812B_ZoneTypeDef bulli_r_blink                = WS2812B_ZONE( bulli_r_blink_spans );
+static const WS2812B_ZoneTypeDef bulli_l_blink                = WS2812B_ZONE( bulli_l_blink_spans );
+static const WS2812B_ZoneTypeDef bulli_r_light                = WS2812B_ZONE( bulli_r_light_spans );
+static const WS2812B_ZoneTypeDef bulli_l_light                = WS2812B_ZONE( bulli_l_light_spans );
+static const WS2812B_ZoneTypeDef bulli_interior_light         = WS2812B_ZONE( bulli_interior_light_spans );
+static uint32_t   animationMs;
+static uint8_t    ignitionFlicker;
 static uint8_t    r;
 static uint8_t    g;
 static uint8_t    b;
@@ -126,7 +108,8 @@ static void       refreshLeds       ( void );
 static void       cbButtonIgnition  ( void );
 static void       cbButtonLeft      ( void );
 static void       cbButtonRight     ( void );
-static uint16_t   msToTicks         ( uint16_t ms );
+static void       cbFrameSent       ( void );
+static bool       isParkable        ( void );
 static void       colorWheelPlus    ( uint8_t *red, uint8_t *green, uint8_t *blue );
 static void       setBlinkerLeft    ( uint8_t param_r, uint8_t param_g, uint8_t param_b );
 static void       setBlinkerRight   ( uint8_t param_r, uint8_t param_g, uint8_t param_b );
@@ -143,14 +126,19 @@ static void       setLightInterior  ( uint8_t param_r, uint8_t param_g, uint8_t
 /// \return    Queue_StatusTypeDef
 Bulli_StatusTypeDef Bulli_init( void )
 {
+#if( CYCLES_ENABLE == 1u )
+   // cycle statistics of the frame pipeline
+   Cycles_init();
+#endif
+   
    // init peripherals for using the ws2812b leds
    if( WS2812B_init() != WS2812B_READY )
    {
       return Bulli_ERROR;
    }
    
-   // init event queue
-   if( Queue_init( &eventQueue, EVENT_QUEUE_CAPACITY ) != QUEUE_OK )
+   // the encoders must agree with the reference encoder on this core
+   if( WS2812B_test() != WS2812B_OK )
    {
       return Bulli_ERROR;
    }
@@ -161,6 +149,12 @@ Bulli_StatusTypeDef Bulli_init( void )
       return Bulli_ERROR;
    }
    
+   // init frame scheduler
+   if( Scheduler_init( BULLI_FPS ) != Scheduler_OK )
+   {
+      return Bulli_ERROR;
+   }
+   
    return Bulli_OK;
 }
 
@@ -176,9 +170,12 @@ void Bulli_run( void )
    bulli.ignition_on = false;
    bulli.blink_left = false;
    bulli.blink_right = false;
+   bulli.frame_sending = false;
+   bulli.frame_latched = false;
    
-   // set initial values for frame counting and coloring
-   framecounter = 0;
+   // set initial values for the animations and coloring
+   animationMs = Scheduler_getMs();
+   ignitionFlicker = MAX_WHITE;
    r = 0xff;
    g = 0x00;   
    b = 0x00;   
@@ -186,8 +183,34 @@ void Bulli_run( void )
    // should never left this loop
    while(1)
    {
+      CYCLES_START( CYCLES_FRAME );
       eventCheck();
+      
+      // full speed for the animated interior, the dark or static frames are rendered on the reduced clock,
+      // the switch is retried next frame while a frame is on the wire
+      if( Power_setClock( bulli.ignition_on != false ? Power_CLOCK_FULL : Power_CLOCK_ECO ) == Power_ERROR )
+      {
+         Error_Handler();
+      }
+      
       refreshLeds();
+      CYCLES_STOP( CYCLES_FRAME );
+      
+      // park in stop mode while the ignition is off, a button wakes the bulli up
+      Power_StatusTypeDef parked = Power_stop( isParkable );
+      if( parked == Power_BUSY )
+      {
+         Scheduler_wait();
+      }
+      else if( parked == Power_OK )
+      {
+         // the frame periods before stop mode have passed without a frame
+         Scheduler_resync();
+      }
+      else
+      {
+         Error_Handler();
+      }
    }
 }
 
@@ -257,6 +280,9 @@ static void eventCheck( void )
             }
          }
       break;
+      case EVENT_FRAME_SENT:
+         bulli.frame_sending = false;
+      break;
       default:;
    }
 }
@@ -269,20 +295,25 @@ static void eventCheck( void )
 /// \return    Queue_StatusTypeDef
 static void refreshLeds( void )
 {
-   // clear framebuffer
-   WS2812B_clearBuffer();
+   CYCLES_START( CYCLES_REFRESH );
+   
+   // animations run on the millisecond clock, so their speed doesn't depend on the frame rate
+   uint32_t now   = Scheduler_getMs();
+   uint32_t steps = (now - animationMs)/ANIMATION_STEP_MS;
+   animationMs   += steps*ANIMATION_STEP_MS;
+   bool     blink = ( now%BLINK_PERIOD_MS < BLINK_PERIOD_MS/2u );
+   
+   // every zone is written each frame, the driver only sends the pixels which changed
    
    // bullis ignition
    if( bulli.ignition_on != false )
    {
-      uint8_t ignitionFlicker;
-      
       // ignition animation
       if( HAL_GPIO_ReadPin(BUTTON_GPIO, BUTTON_0_PIN) )
       {
          ignitionFlicker = MAX_WHITE;
       }
-      else
+      else if( steps != 0u )
       {
          ignitionFlicker = rand()%MAX_WHITE;
       }
@@ -290,19 +321,23 @@ static void refreshLeds( void )
       setLightRight( ignitionFlicker, ignitionFlicker, ignitionFlicker );
       
       // bullis interior lights
-      colorWheelPlus( &r, &g, &b );
+      for( uint32_t step = 0u; step < steps; step++ )
+      {
+         colorWheelPlus( &r, &g, &b );
+      }
       setLightInterior( r, g, b );
    }
    else
    {
       setLightLeft(0x00, 0x00, 0x00);
       setLightRight(0x00, 0x00, 0x00);
+      setLightInterior(0x00, 0x00, 0x00);
    }
    
    // bullis left blinker animation
    if( bulli.blink_left != false )
    {
-      if( framecounter%msToTicks(2000) < msToTicks(1000) )
+      if( blink != false )
       {
          setBlinkerLeft(0xff, 0x80, 0x00);
       }
@@ -319,7 +354,7 @@ static void refreshLeds( void )
    // bullis right blinker animation
    if( bulli.blink_right != false )
    {
-      if( framecounter%msToTicks(2000) < msToTicks(1000) )
+      if( blink != false )
       {
          setBlinkerRight(0xff, 0x80, 0x00);
       }
@@ -333,9 +368,25 @@ static void refreshLeds( void )
       setBlinkerRight(0x00, 0x00, 0x00);
    }
    
-   WS2812B_sendBuffer();
-   HAL_Delay(REFRESH_PERIOD_MS);
-   framecounter++;
+   // send unless the previous frame is still on the wire, the changes stay marked for the next period,
+   // the state query covers a frame sent event lost on a full queue
+   bulli.frame_latched = false;
+   if( bulli.frame_sending == false || WS2812B_getState() == WS2812B_READY )
+   {
+      WS2812B_StatusTypeDef status = WS2812B_sendBufferAsync( cbFrameSent );
+      
+      if( status == WS2812B_OK )
+      {
+         bulli.frame_sending = true;
+      }
+      else if( status == WS2812B_READY )
+      {
+         // nothing changed since the last frame, which has been latched unless it is still on the wire
+         bulli.frame_latched = ( WS2812B_getState() == WS2812B_READY );
+      }
+   }
+   
+   CYCLES_STOP( CYCLES_REFRESH );
 }
 
 // ----------------------------------------------------------------------------
@@ -348,13 +399,7 @@ static void refreshLeds( void )
 /// \return    none
 static void setBlinkerLeft( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 {
-   for( uint16_t x=bulli_l_blink.col_start; x<=bulli_l_blink.col_end; x++  )
-   {
-      for( uint8_t y=bulli_l_blink.row_start; y<=bulli_l_blink.row_end; y++  )
-      {
-         WS2812B_setPixel( y, x, param_r, param_g, param_b );
-      }
-   }
+   WS2812B_fillZone( &bulli_l_blink, param_r, param_g, param_b );
 }
 
 // ----------------------------------------------------------------------------
@@ -367,13 +412,7 @@ static void setBlinkerLeft( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 /// \return    none
 static void setBlinkerRight( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 {
-   for( uint16_t x=bulli_r_blink.col_start; x<=bulli_r_blink.col_end; x++  )
-   {
-      for( uint8_t y=bulli_r_blink.row_start; y<=bulli_r_blink.row_end; y++  )
-      {
-         WS2812B_setPixel( y, x, param_r, param_g, param_b );
-      }
-   }
+   WS2812B_fillZone( &bulli_r_blink, param_r, param_g, param_b );
 }
 
 // ----------------------------------------------------------------------------
@@ -386,13 +425,7 @@ static void setBlinkerRight( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 /// \return    none
 static void setLightLeft( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 {
-   for( uint16_t x=bulli_l_light.col_start; x<=bulli_l_light.col_end; x++  )
-   {
-      for( uint8_t y=bulli_l_light.row_start; y<=bulli_l_light.row_end; y++  )
-      {
-         WS2812B_setPixel( y, x, param_r, param_g, param_b );
-      }
-   }
+   WS2812B_fillZone( &bulli_l_light, param_r, param_g, param_b );
 }
 
 // ----------------------------------------------------------------------------
@@ -405,13 +438,7 @@ static void setLightLeft( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 /// \return    none
 static void setLightRight( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 {
-   for( uint16_t x=bulli_r_light.col_start; x<=bulli_r_light.col_end; x++  )
-   {
-      for( uint8_t y=bulli_r_light.row_start; y<=bulli_r_light.row_end; y++  )
-      {
-         WS2812B_setPixel( y, x, param_r, param_g, param_b );
-      }
-   }
+   WS2812B_fillZone( &bulli_r_light, param_r, param_g, param_b );
 }
 
 // ----------------------------------------------------------------------------
@@ -424,24 +451,7 @@ static void setLightRight( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 /// \return    none
 static void setLightInterior( uint8_t param_r, uint8_t param_g, uint8_t param_b )
 {
-   for( uint16_t x=bulli_interior_light.col_start; x<=bulli_interior_light.col_end; x++  )
-   {
-      for( uint8_t y=bulli_interior_light.row_start; y<=bulli_interior_light.row_end; y++  )
-      {
-         WS2812B_setPixel( y, x, param_r, param_g, param_b );
-      }
-   }
-}
-
-// ----------------------------------------------------------------------------
-/// \brief     Convertion from ms into ticks
-///
-/// \param     [in]  uint16_t ms
-///
-/// \return    uint16_t ticks
-static uint16_t msToTicks( uint16_t ms )
-{
-   return (uint16_t)((double)ms/(double)REFRESH_PERIOD_MS);
+   WS2812B_fillZone( &bulli_interior_light, param_r, param_g, param_b );
 }
 
 // ----------------------------------------------------------------------------
@@ -471,6 +481,21 @@ static void colorWheelPlus( uint8_t *red, uint8_t *green, uint8_t *blue )
 }
 
 
+// ----------------------------------------------------------------------------
+/// \brief     Checks if the bulli may be parked in stop mode. Called with the
+///            interrupts masked. With WS2812B_DITHER every frame is sent, the
+///            dark frame is never reported as latched and the bulli doesn't
+///            park.
+///
+/// \param     none
+///
+/// \return    bool, true if the ignition is off, the dark frame has been
+///            latched and no event is waiting
+static bool isParkable( void )
+{
+   return bulli.ignition_on == false && bulli.frame_latched != false && Queue_isEmpty( &eventQueue ) != false;
+}
+
 // ----------------------------------------------------------------------------
 /// \brief     Ignition button callback.
 ///
@@ -505,6 +530,18 @@ static void cbButtonRight( void )
 }
 
 // ----------------------------------------------------------------------------
+/// \brief     Frame sent callback, called from the ws2812b transfer complete
+///            interrupt once the leds show the frame.
+///
+/// \param     none
+///
+/// \return    none
+static void cbFrameSent( void )
+{
+   Queue_enqueue( &eventQueue, EVENT_FRAME_SENT );
+}
+
+// ----------------------------------------------------------------------------
 
 
 
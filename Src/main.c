@@ -46,6 +46,7 @@
 #include <stdlib.h>
 #include "main.h"
 #include "bulli.h"
+#include "power.h"
 
 /* Private includes ----------------------------------------------------------*/
 
@@ -94,40 +95,15 @@ int main( void )
 
 // ----------------------------------------------------------------------------
 /// \brief     System Clock configuration according to the blue pills crystals.
-///            HSE is set to 8 MHz and LSE is set to 32 kHz.
+///            HSE is set to 8 MHz, the full speed profile of the power module
+///            runs the pll at 72 MHz. The profiles are set up in power.c only.
 ///
 /// \param     none
 ///
 /// \return    none
 void SystemClock_Config( void )
 {
-   RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-   RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
-   
-   /** Initializes the RCC Oscillators according to the specified parameters
-   * in the RCC_OscInitTypeDef structure.
-   */
-   RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
-   RCC_OscInitStruct.HSEState = RCC_HSE_ON;
-   RCC_OscInitStruct.HSEPredivValue = RCC_HSE_PREDIV_DIV1;
-   RCC_OscInitStruct.HSIState = RCC_HSI_ON;
-   RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
-   RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
-   RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL9;
-   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
-   {
-      Error_Handler();
-   }
-   /** Initializes the CPU, AHB and APB buses clocks
-   */
-   RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
-                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
-   RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
-   RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-   RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
-   RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
-   
-   if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2) != HAL_OK)
+   if( Power_initClock() != Power_OK )
    {
       Error_Handler();
    }
@@ -0,0 +1,254 @@
+// ****************************************************************************
+/// \file      power.c
+///
+/// \brief     Power C Source File
+///
+/// \details   Parking of the bulli in stop mode and the system clock
+///            profiles. In stop mode all clocks of the core domain are
+///            stopped, sram and the peripheral registers are kept. The
+///            button pins wake the core through their exti lines.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+/// 
+/// \copyright Copyright (c) 2026 Nico Korn
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "power.h"
+#include "button.h"
+#include "ws2812b.h"
+#include "scheduler.h"
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+   uint32_t    pllmul;
+   uint32_t    latency;
+   uint32_t    ahb;        // hclk divider
+   uint32_t    apb1;       // pclk1 divider, at most 36 MHz
+   uint32_t    apb2;       // pclk2 divider
+}Power_clock_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+// the only clock tree setup of the firmware, SystemClock_Config starts with the full profile
+// the timers must run at SystemCoreClock on every profile, a divided apb doubles its timer clock again
+static const Power_clock_t powerClocks[] =
+{
+   [Power_CLOCK_FULL]   = { .pllmul = RCC_PLL_MUL9, .latency = FLASH_LATENCY_2, .ahb = RCC_SYSCLK_DIV1, .apb1 = RCC_HCLK_DIV2, .apb2 = RCC_HCLK_DIV1 },
+   [Power_CLOCK_ECO]    = { .pllmul = RCC_PLL_MUL3, .latency = FLASH_LATENCY_0, .ahb = RCC_SYSCLK_DIV1, .apb1 = RCC_HCLK_DIV2, .apb2 = RCC_HCLK_DIV1 }
+};
+static Power_ClockTypeDef powerClock = Power_CLOCK_FULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static Power_StatusTypeDef config_clock( Power_ClockTypeDef clock );
+
+/* Private user code ---------------------------------------------------------*/
+
+// ----------------------------------------------------------------------------
+/// \brief     Configures the clock tree of the full speed profile after
+///            reset, called by SystemClock_Config before the peripherals are
+///            set up.
+///
+/// \param     none
+///
+/// \return    Power_StatusTypeDef
+Power_StatusTypeDef Power_initClock( void )
+{
+   powerClock = Power_CLOCK_FULL;
+   
+   return config_clock( Power_CLOCK_FULL );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Enters stop mode until a button is pressed. The mcu isn't
+///            stopped while a button is debounced, because the debounce timer
+///            stops with the clocks, or while a frame is on the wire. After
+///            the wake up the clock tree is configured again, the core wakes
+///            on hsi. The timers keep their configuration and run at the
+///            same rate as before.
+///
+/// \param     [in] bool (*isIdle)(void), checked with the interrupts masked
+///            right before stopping, so no event can slip in between
+///
+/// \return    Power_StatusTypeDef, Power_BUSY if the mcu hasn't been stopped,
+///            Power_ERROR if the clock tree couldn't be restored
+Power_StatusTypeDef Power_stop( bool (*isIdle)(void) )
+{
+   // a pending interrupt still wakes the core with the interrupts masked
+   __disable_irq();
+   
+   if( Button_isBusy() != false || WS2812B_getState() != WS2812B_READY || isIdle() == false )
+   {
+      __enable_irq();
+      return Power_BUSY;
+   }
+   
+   HAL_SuspendTick();
+   HAL_PWR_EnterSTOPMode( PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI );
+   
+   // the hal times out its oscillator waits on SysTick, so the tick has to run before the
+   // clock tree is restored, the wake up interrupt is handled on hsi meanwhile
+   HAL_ResumeTick();
+   __enable_irq();
+   
+   // restore hse, pll and the bus prescalers of the running profile
+   if( config_clock( powerClock ) != Power_OK )
+   {
+      return Power_ERROR;
+   }
+   
+   return Power_OK;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Switches the system clock to another profile. SysTick is set up
+///            again by the hal, the led, button and scheduler timers derive
+///            their prescalers again, so their timing is the same on every
+///            profile. The clock isn't switched while a frame is on the wire.
+///
+/// \param     [in] Power_ClockTypeDef clock
+///
+/// \return    Power_StatusTypeDef, Power_BUSY if the clock hasn't been switched,
+///            Power_ERROR if the clock tree or the led timer couldn't be set up
+Power_StatusTypeDef Power_setClock( Power_ClockTypeDef clock )
+{
+   if( clock == powerClock )
+   {
+      return Power_OK;
+   }
+   
+   // a queued frame is only started while the running one is on the wire
+   __disable_irq();
+   
+   if( WS2812B_getState() != WS2812B_READY )
+   {
+      __enable_irq();
+      return Power_BUSY;
+   }
+   
+   __enable_irq();
+   
+   // only the main loop starts frames, so the leds stay idle while the clock tree is configured
+   // with the interrupts enabled, the hal times out its oscillator waits on SysTick
+   if( config_clock( clock ) != Power_OK )
+   {
+      return Power_ERROR;
+   }
+   powerClock = clock;
+   
+   Button_updateClock();
+   Scheduler_updateClock();
+   if( WS2812B_updateClock() != WS2812B_OK )
+   {
+      return Power_ERROR;
+   }
+   
+   return Power_OK;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the running clock profile.
+///
+/// \param     none
+///
+/// \return    Power_ClockTypeDef
+Power_ClockTypeDef Power_getClock( void )
+{
+   return powerClock;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Configures hse, pll and the bus prescalers for a clock profile.
+///            The pll can't be changed while it clocks the system, so the
+///            system runs from hse in between. Also used after stop mode,
+///            where the core wakes on hsi.
+///
+/// \param     [in] Power_ClockTypeDef clock
+///
+/// \return    Power_StatusTypeDef
+static Power_StatusTypeDef config_clock( Power_ClockTypeDef clock )
+{
+   RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+   RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+   
+   RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+   RCC_ClkInitStruct.AHBCLKDivider = powerClocks[clock].ahb;
+   RCC_ClkInitStruct.APB1CLKDivider = powerClocks[clock].apb1;
+   RCC_ClkInitStruct.APB2CLKDivider = powerClocks[clock].apb2;
+   
+   if( __HAL_RCC_GET_SYSCLK_SOURCE() == RCC_SYSCLKSOURCE_STATUS_PLLCLK )
+   {
+      RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSE;
+      if( HAL_RCC_ClockConfig(&RCC_ClkInitStruct, __HAL_FLASH_GET_LATENCY()) != HAL_OK )
+      {
+         return Power_ERROR;
+      }
+   }
+   
+   RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+   RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+   RCC_OscInitStruct.HSEPredivValue = RCC_HSE_PREDIV_DIV1;
+   RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+   RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+   RCC_OscInitStruct.PLL.PLLMUL = powerClocks[clock].pllmul;
+   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+   {
+      return Power_ERROR;
+   }
+   
+   RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+   if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, powerClocks[clock].latency) != HAL_OK)
+   {
+      return Power_ERROR;
+   }
+   
+   // the led (TIM2), scheduler (TIM3) and button (TIM1) timers derive their prescalers from SystemCoreClock
+   if( HAL_RCC_GetPCLK1Freq()*( ( powerClocks[clock].apb1 == RCC_HCLK_DIV1 ) ? 1u : 2u ) != SystemCoreClock
+    || HAL_RCC_GetPCLK2Freq()*( ( powerClocks[clock].apb2 == RCC_HCLK_DIV1 ) ? 1u : 2u ) != SystemCoreClock )
+   {
+      return Power_ERROR;
+   }
+   
+   return Power_OK;
+}
+
+/************************ (C) COPYRIGHT Nico Korn ***************END OF FILE****/
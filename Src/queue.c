@@ -3,7 +3,12 @@
 ///
 /// \brief     Queue C Source File
 ///
-/// \details   A generic queue
+/// \details   A generic single producer, single consumer queue. The
+///            producer only writes tail, the consumer only writes head, so
+///            an interrupt may enqueue while the main loop dequeues without
+///            any critical section. Several producers must not preempt each
+///            other, e.g. interrupts of the same priority. The storage is
+///            declared statically with QUEUE_DEFINE, no heap is used.
 ///
 /// \author    Nico Korn
 ///
@@ -43,7 +48,6 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdio.h>
-#include <stdlib.h>
 #include "queue.h"
 
 /* Private includes ----------------------------------------------------------*/
@@ -61,36 +65,7 @@
 /* Private user code ---------------------------------------------------------*/
 
 // ----------------------------------------------------------------------------
-/// \brief     Queue initialisation.
-///
-/// \param     [in/out] queue_t *queue
-/// \param     [in]     uint16_t capacity
-///
-/// \return    Queue_StatusTypeDef
-Queue_StatusTypeDef Queue_init( Queue_t *queue, uint16_t capacity )
-{
-   if( capacity == 0 )
-   {
-      return QUEUE_ERR_PARAM;
-   }
-   
-   queue->array = (uint8_t*)malloc(capacity);
-   
-   if( queue == NULL )
-   {
-      return QUEUE_ERR_NOMEM;
-   }
-   
-   queue->capacity   = capacity;
-   queue->size       = 0;
-   queue->head       = 0;
-   queue->tail       = 0;
-   
-	return QUEUE_OK;
-}
-
-// ----------------------------------------------------------------------------
-/// \brief     Queue enqueue.
+/// \brief     Queue enqueue, producer side.
 ///
 /// \param     [in/out] queue_t *queue
 /// \param     [in]     uint8_t item
@@ -103,20 +78,24 @@ Queue_StatusTypeDef Queue_enqueue( Queue_t *queue, uint8_t item )
       return QUEUE_ERR_PARAM;
    }
    
-   if( queue->size == queue->capacity )
+   uint16_t tail = queue->tail;
+   
+   if( (uint16_t)(tail - queue->head) == queue->capacity )
    {
       return QUEUE_ERR_NPSPC;
    }
    
-   queue->array[queue->tail%queue->capacity] = item;
-   queue->tail++;
-   queue->size++;
+   queue->array[tail & queue->mask] = item;
+   
+   // the item must be stored before the consumer sees the new tail
+   __DMB();
+   queue->tail = tail+1u;
    
    return QUEUE_OK;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Queue dequeue.
+/// \brief     Queue dequeue, consumer side.
 ///
 /// \param     [in/out] queue_t *queue
 /// \param     [in/out] uint8_t *item
@@ -124,40 +103,37 @@ Queue_StatusTypeDef Queue_enqueue( Queue_t *queue, uint8_t item )
 /// \return    Queue_StatusTypeDef
 Queue_StatusTypeDef Queue_dequeue( Queue_t *queue, uint8_t *item )
 {
-   if( queue->size == 0 )
+   if( item == NULL )
    {
-      *item = 0;
-      return QUEUE_ERR_EMPTY;
+      return QUEUE_ERR_PARAM;
    }
    
-   if( item == NULL )
+   uint16_t head = queue->head;
+   
+   if( head == queue->tail )
    {
-      return QUEUE_ERR_PARAM;
+      *item = 0;
+      return QUEUE_ERR_EMPTY;
    }
    
-   *item = queue->array[queue->head%queue->capacity];
-   queue->head++;
-   queue->size--;
+   // the item is read after the tail which published it and before the slot is released
+   __DMB();
+   *item = queue->array[head & queue->mask];
+   __DMB();
+   queue->head = head+1u;
    
    return QUEUE_OK; 
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Frees memory.
+/// \brief     Checks if the queue is empty.
 ///
-/// \param     [in/out] queue_t *queue
+/// \param     [in] queue_t *queue
 ///
-/// \return    Queue_StatusTypeDef
-Queue_StatusTypeDef Queue_kill( Queue_t *queue )
+/// \return    bool
+bool Queue_isEmpty( Queue_t *queue )
 {
-   if( queue == NULL )
-   {
-      return QUEUE_ERR_PARAM;
-   }
-   
-   free( queue->array );
-   
-   return QUEUE_OK; 
+   return ( queue->head == queue->tail );
 }
 
 // ----------------------------------------------------------------------------
@@ -168,12 +144,13 @@ Queue_StatusTypeDef Queue_kill( Queue_t *queue )
 /// \return    Queue_StatusTypeDef
 Queue_StatusTypeDef Queue_test( void )
 {
-   Queue_t queue_test;
-   uint16_t queue_capcacity = 10;
-   uint8_t queue_items[10] = {0,1,2,3,4,5,6,7,8,9};
+   QUEUE_DEFINE( queue_test, 8u );
+   uint16_t queue_capcacity = queue_test.capacity;
+   uint8_t queue_items[8] = {0,1,2,3,4,5,6,7};
    uint8_t queue_item;
    
-   if( Queue_init( &queue_test, queue_capcacity ) != QUEUE_OK )
+   // a previous run leaves the queue empty
+   if( Queue_isEmpty( &queue_test ) == false )
    {
       return QUEUE_ERR_TEST;
    }
@@ -206,10 +183,39 @@ Queue_StatusTypeDef Queue_test( void )
       return QUEUE_ERR_TEST;
    }
    
-   // kill the queue now
-   if( Queue_kill( &queue_test ) != QUEUE_OK )
+   // run the free running indexes over their wrap at 65536 with a varying fill level
+   uint8_t in  = 0;
+   uint8_t out = 0;
+   for( uint32_t i=0; i<0x8000u; i++ )
    {
-      return QUEUE_ERR_TEST;
+      for( uint16_t n=0; n<=i%queue_capcacity; n++ )
+      {
+         if( Queue_enqueue( &queue_test, in ) != QUEUE_OK )
+         {
+            return QUEUE_ERR_TEST;
+         }
+         in++;
+      }
+      
+      // full at the capacity
+      if( i%queue_capcacity == queue_capcacity-1u && Queue_enqueue( &queue_test, 0xff ) != QUEUE_ERR_NPSPC )
+      {
+         return QUEUE_ERR_TEST;
+      }
+      
+      while( Queue_dequeue( &queue_test, &queue_item ) == QUEUE_OK )
+      {
+         if( queue_item != out )
+         {
+            return QUEUE_ERR_TEST;
+         }
+         out++;
+      }
+      
+      if( out != in || Queue_isEmpty( &queue_test ) == false )
+      {
+         return QUEUE_ERR_TEST;
+      }
    }
    
    return QUEUE_OK; 
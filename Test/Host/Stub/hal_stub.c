@@ -0,0 +1,575 @@
+// ****************************************************************************
+/// \file      hal_stub.c
+///
+/// \brief     Host Stub HAL Simulation C Source File
+///
+/// \details   Simulates TIM2 and the DMA1 channels on the host. Every call of
+///            Stub_step is one tick of the timer counter clock: the update
+///            event and the compare matches of cc1 and cc2 request a transfer
+///            of their channel, which copies one halfword from the memory
+///            address to GPIOA->ODR like the dma on the target. Half and full
+///            transfer set the flags of the channel and pend its interrupt,
+///            which is taken once PRIMASK is cleared. __WFI runs the timer
+///            until an interrupt is pending, __NOP in a busy wait runs it
+///            for one tick.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+///
+/// \copyright Copyright (c) 2026 Nico Korn
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_stub.h"
+
+// Private define *************************************************************
+#define CHANNELS                ( 7u )
+#define IRQN_CHANNEL1           ( 11 )          // DMA1_Channel1_IRQn, the channels follow in order
+#define TICKS_MAX               ( 100000000u )  // a transfer which doesn't end within this is stuck
+
+// Private variables **********************************************************
+static uint32_t            tick;
+static bool                primask;
+static bool                inIrq;
+static uint32_t            pending;                   // pending interrupt per channel index
+static uint32_t            irqTick;                   // tick of the last interrupt taken
+static bool                nvicEnabled[CHANNELS];
+static uint32_t            nvicPriority[CHANNELS];
+static uint32_t            memAddress[CHANNELS];      // current memory address of the channel
+static uint32_t            memCount[CHANNELS];        // transfer count when the channel was enabled
+static uint32_t            writeCapacity;
+static uint32_t            configCapacity;
+
+// Global variables ***********************************************************
+uint32_t                   SystemCoreClock = 72000000u;
+TIM_TypeDef                Stub_TIM2;
+GPIO_TypeDef               Stub_GPIOA;
+DMA_TypeDef                Stub_DMA1;
+DMA_Channel_TypeDef        Stub_DMA1_Channel[7];
+Stub_WriteTypeDef          *Stub_Writes;
+uint32_t                   Stub_WriteCount;
+Stub_ConfigTypeDef         *Stub_Configs;
+uint32_t                   Stub_ConfigCount;
+
+// Private function prototypes ************************************************
+static void                clear_flags             ( void );
+static void                request                 ( uint8_t index );
+static void                deliver                 ( void );
+static uint8_t             channel_index           ( const DMA_Channel_TypeDef *channel );
+
+// Functions ******************************************************************
+// ----------------------------------------------------------------------------
+/// \brief     Default interrupt handlers of the channels, the drivers
+///            define the handlers they use.
+///
+/// \param     none
+///
+/// \return    none
+__attribute__((weak)) void DMA1_Channel2_IRQHandler( void )
+{
+   Stub_fail( "unexpected interrupt of dma1 channel 2" );
+}
+
+__attribute__((weak)) void DMA1_Channel5_IRQHandler( void )
+{
+   Stub_fail( "unexpected interrupt of dma1 channel 5" );
+}
+
+__attribute__((weak)) void DMA1_Channel7_IRQHandler( void )
+{
+   Stub_fail( "unexpected interrupt of dma1 channel 7" );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Clears the recorded configurations and writes, the driver
+///            state and the timer tick are kept.
+///
+/// \param     none
+///
+/// \return    none
+void Stub_reset( void )
+{
+   Stub_WriteCount   = 0u;
+   Stub_ConfigCount  = 0u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the timer tick, counted in timer counter clocks.
+///
+/// \param     none
+///
+/// \return    uint32_t
+uint32_t Stub_getTick( void )
+{
+   return tick;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Advances TIM2 by one tick and serves the dma requests of the
+///            update event and the compare matches.
+///
+/// \param     none
+///
+/// \return    bool, false if TIM2 is stopped
+bool Stub_step( void )
+{
+   if( (Stub_TIM2.CR1 & TIM_CR1_CEN) == 0u )
+   {
+      deliver();
+      return false;
+   }
+
+   tick++;
+
+   if( Stub_TIM2.CNT >= Stub_TIM2.ARR )
+   {
+      Stub_TIM2.CNT = 0u;
+      if( (Stub_TIM2.DIER & TIM_DIER_UDE) != 0u )
+      {
+         request( 1u );
+      }
+   }
+   else
+   {
+      Stub_TIM2.CNT++;
+   }
+
+   if( Stub_TIM2.CNT == Stub_TIM2.CCR1 && (Stub_TIM2.DIER & TIM_DIER_CC1DE) != 0u )
+   {
+      request( 4u );
+   }
+
+   if( Stub_TIM2.CNT == Stub_TIM2.CCR2 && (Stub_TIM2.DIER & TIM_DIER_CC2DE) != 0u )
+   {
+      request( 6u );
+   }
+
+   deliver();
+
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs TIM2 for a number of ticks or until it is stopped.
+///
+/// \param     [in] uint32_t ticks
+///
+/// \return    none
+void Stub_runTicks( uint32_t ticks )
+{
+   while( ticks-- > 0u && Stub_step() != false )
+   {
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs TIM2 until the transfers have ended and it is stopped.
+///
+/// \param     none
+///
+/// \return    none
+void Stub_runIdle( void )
+{
+   uint32_t start = tick;
+
+   while( Stub_step() != false )
+   {
+      if( tick - start > TICKS_MAX )
+      {
+         Stub_fail( "the transfer doesn't end" );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Reports a failed check and ends the test.
+///
+/// \param     [in] const char *message
+///
+/// \return    none
+void Stub_fail( const char *message )
+{
+   fprintf( stderr, "FAIL: %s (tick %u)\n", message, (unsigned)tick );
+   exit( EXIT_FAILURE );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     assert_param of the drivers.
+///
+/// \param     [in] const char *file
+/// \param     [in] int line
+///
+/// \return    none
+void Stub_assert( const char *file, int line )
+{
+   fprintf( stderr, "FAIL: assert_param in %s:%d\n", file, line );
+   exit( EXIT_FAILURE );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     __disable_irq, __enable_irq and __WFI. The core sleeps in
+///            __WFI until an interrupt is pending, also with PRIMASK set.
+///
+/// \param     none
+///
+/// \return    none
+void Stub_disableIrq( void )
+{
+   primask = true;
+}
+
+void Stub_enableIrq( void )
+{
+   primask = false;
+   deliver();
+}
+
+void Stub_wfi( void )
+{
+   uint32_t start = tick;
+
+   while( pending == 0u )
+   {
+      if( Stub_step() == false && pending == 0u )
+      {
+         Stub_fail( "wfi without a running transfer, the core would sleep forever" );
+      }
+
+      if( tick - start > TICKS_MAX )
+      {
+         Stub_fail( "wfi isn't woken up" );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     __NOP in the body of a busy wait. The core spins on a state
+///            only the interrupts change, every spin is one tick.
+///
+/// \param     none
+///
+/// \return    none
+void Stub_nop( void )
+{
+   if( Stub_step() == false )
+   {
+      Stub_fail( "busy wait without a running transfer, the core would spin forever" );
+   }
+
+   if( tick - irqTick > TICKS_MAX )
+   {
+      Stub_fail( "busy wait isn't ended by an interrupt" );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Takes over the configuration of a channel on enabling it, like
+///            the dma does, and records it.
+///
+/// \param     [in] DMA_Channel_TypeDef *channel
+///
+/// \return    none
+void Stub_dmaEnable( DMA_Channel_TypeDef *channel )
+{
+   uint8_t index = channel_index( channel );
+
+   channel->CCR      |= DMA_CCR_EN;
+   memAddress[index] = channel->CMAR;
+   memCount[index]   = channel->CNDTR;
+
+   if( Stub_ConfigCount == configCapacity )
+   {
+      configCapacity = configCapacity*2u + 16u;
+      Stub_Configs   = realloc( Stub_Configs, configCapacity*sizeof(Stub_ConfigTypeDef) );
+   }
+
+   Stub_Configs[Stub_ConfigCount++] = (Stub_ConfigTypeDef){ tick, (uint8_t)(index + 1u), channel->CCR, channel->CNDTR, channel->CMAR, channel->CPAR };
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     HAL functions used by the drivers.
+HAL_StatusTypeDef HAL_TIM_Base_Init( TIM_HandleTypeDef *htim )
+{
+   htim->Instance->ARR  = htim->Init.Period;
+   htim->Instance->PSC  = htim->Init.Prescaler;
+   htim->Instance->CNT  = 0u;
+
+   return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel( TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel )
+{
+   if( Channel == TIM_CHANNEL_1 )
+   {
+      htim->Instance->CCR1 = sConfig->Pulse;
+   }
+   else if( Channel == TIM_CHANNEL_2 )
+   {
+      htim->Instance->CCR2 = sConfig->Pulse;
+   }
+   else
+   {
+      return HAL_ERROR;
+   }
+
+   return HAL_OK;
+}
+
+void TIM_CCxChannelCmd( TIM_TypeDef *TIMx, uint32_t Channel, uint32_t ChannelState )
+{
+   TIMx->CCER &= ~(1u << Channel);
+   TIMx->CCER |= ChannelState << Channel;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init( DMA_HandleTypeDef *hdma )
+{
+   hdma->DmaBaseAddress       = &Stub_DMA1;
+   hdma->ChannelIndex         = channel_index( hdma->Instance )*4u;
+   hdma->XferCpltCallback     = NULL;
+   hdma->XferHalfCpltCallback = NULL;
+   hdma->XferErrorCallback    = NULL;
+   hdma->Instance->CCR        = hdma->Init.Direction | hdma->Init.PeriphInc | hdma->Init.MemInc | hdma->Init.PeriphDataAlignment
+                              | hdma->Init.MemDataAlignment | hdma->Init.Mode | hdma->Init.Priority;
+
+   return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_RegisterCallback( DMA_HandleTypeDef *hdma, HAL_DMA_CallbackIDTypeDef CallbackID, void (*pCallback)( DMA_HandleTypeDef *_hdma ) )
+{
+   switch( CallbackID )
+   {
+      case HAL_DMA_XFER_CPLT_CB_ID:
+         hdma->XferCpltCallback = pCallback;
+         break;
+      case HAL_DMA_XFER_HALFCPLT_CB_ID:
+         hdma->XferHalfCpltCallback = pCallback;
+         break;
+      case HAL_DMA_XFER_ERROR_CB_ID:
+         hdma->XferErrorCallback = pCallback;
+         break;
+      default:
+         return HAL_ERROR;
+   }
+
+   return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler( DMA_HandleTypeDef *hdma )
+{
+   clear_flags();
+
+   uint32_t flags    = hdma->DmaBaseAddress->ISR >> hdma->ChannelIndex;
+   uint32_t sources  = hdma->Instance->CCR;
+
+   // same order and flag handling as the hal
+   if( (flags & DMA_ISR_HTIF1) != 0u && (sources & DMA_CCR_HTIE) != 0u )
+   {
+      if( (sources & DMA_CCR_CIRC) == 0u )
+      {
+         hdma->Instance->CCR &= ~DMA_CCR_HTIE;
+      }
+      hdma->DmaBaseAddress->ISR &= ~(DMA_ISR_HTIF1 << hdma->ChannelIndex);
+      if( hdma->XferHalfCpltCallback != NULL )
+      {
+         hdma->XferHalfCpltCallback( hdma );
+      }
+   }
+   else if( (flags & DMA_ISR_TCIF1) != 0u && (sources & DMA_CCR_TCIE) != 0u )
+   {
+      if( (sources & DMA_CCR_CIRC) == 0u )
+      {
+         hdma->Instance->CCR &= ~(DMA_CCR_TEIE | DMA_CCR_TCIE);
+      }
+      hdma->DmaBaseAddress->ISR &= ~(DMA_ISR_TCIF1 << hdma->ChannelIndex);
+      if( hdma->XferCpltCallback != NULL )
+      {
+         hdma->XferCpltCallback( hdma );
+      }
+   }
+}
+
+void HAL_NVIC_SetPriority( IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority )
+{
+   nvicPriority[IRQn - IRQN_CHANNEL1] = PreemptPriority*16u + SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ( IRQn_Type IRQn )
+{
+   nvicEnabled[IRQn - IRQN_CHANNEL1] = true;
+}
+
+void HAL_NVIC_ClearPendingIRQ( IRQn_Type IRQn )
+{
+   pending &= ~(1u << (IRQn - IRQN_CHANNEL1));
+}
+
+void HAL_GPIO_Init( GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init )
+{
+   GPIOx->ODR = 0u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Applies the writes to the interrupt flag clear register, a
+///            cleared global flag clears all flags of the channel.
+///
+/// \param     none
+///
+/// \return    none
+static void clear_flags( void )
+{
+   uint32_t clear = Stub_DMA1.IFCR;
+
+   for( uint8_t index = 0; index < CHANNELS; index++ )
+   {
+      if( (clear & (DMA_ISR_GIF1 << (index*4u))) != 0u )
+      {
+         clear |= 0xFu << (index*4u);
+      }
+   }
+
+   Stub_DMA1.ISR  &= ~clear;
+   Stub_DMA1.IFCR = 0u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Serves a dma request of a channel, one halfword from the
+///            memory address to GPIOA->ODR.
+///
+/// \param     [in] uint8_t index, channel-1
+///
+/// \return    none
+static void request( uint8_t index )
+{
+   DMA_Channel_TypeDef *channel = &Stub_DMA1_Channel[index];
+
+   clear_flags();
+
+   if( (channel->CCR & DMA_CCR_EN) == 0u || channel->CNDTR == 0u )
+   {
+      return;
+   }
+
+   if( channel->CPAR != (uint32_t)(uintptr_t)&Stub_GPIOA.ODR || (channel->CCR & DMA_CCR_DIR) == 0u )
+   {
+      Stub_fail( "the dma doesn't write to GPIOA->ODR" );
+   }
+
+   uint16_t value = *(const uint16_t*)(uintptr_t)memAddress[index];
+   Stub_GPIOA.ODR = value;
+
+   if( Stub_WriteCount == writeCapacity )
+   {
+      writeCapacity  = writeCapacity*2u + 1024u;
+      Stub_Writes    = realloc( Stub_Writes, writeCapacity*sizeof(Stub_WriteTypeDef) );
+   }
+   Stub_Writes[Stub_WriteCount++] = (Stub_WriteTypeDef){ tick, (uint8_t)(index + 1u), value };
+
+   if( (channel->CCR & DMA_CCR_MINC) != 0u )
+   {
+      memAddress[index] += sizeof(uint16_t);
+   }
+   channel->CNDTR--;
+
+   if( channel->CNDTR == memCount[index]/2u )
+   {
+      Stub_DMA1.ISR |= (DMA_ISR_GIF1 | DMA_ISR_HTIF1) << (index*4u);
+      if( (channel->CCR & DMA_CCR_HTIE) != 0u && nvicEnabled[index] != false )
+      {
+         pending |= 1u << index;
+      }
+   }
+
+   if( channel->CNDTR == 0u )
+   {
+      Stub_DMA1.ISR |= (DMA_ISR_GIF1 | DMA_ISR_TCIF1) << (index*4u);
+      if( (channel->CCR & DMA_CCR_TCIE) != 0u && nvicEnabled[index] != false )
+      {
+         pending |= 1u << index;
+      }
+
+      if( (channel->CCR & DMA_CCR_CIRC) != 0u )
+      {
+         channel->CNDTR    = memCount[index];
+         memAddress[index] = channel->CMAR;
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Takes the pending interrupts by priority while PRIMASK is
+///            clear. The handlers aren't nested.
+///
+/// \param     none
+///
+/// \return    none
+static void deliver( void )
+{
+   static void (* const handlers[CHANNELS])( void ) = { NULL, DMA1_Channel2_IRQHandler, NULL, NULL, DMA1_Channel5_IRQHandler, NULL, DMA1_Channel7_IRQHandler };
+
+   while( primask == false && inIrq == false && pending != 0u )
+   {
+      uint8_t next = CHANNELS;
+
+      for( uint8_t index = 0; index < CHANNELS; index++ )
+      {
+         if( (pending & (1u << index)) != 0u && ( next == CHANNELS || nvicPriority[index] < nvicPriority[next] ) )
+         {
+            next = index;
+         }
+      }
+
+      if( handlers[next] == NULL )
+      {
+         Stub_fail( "interrupt without a handler" );
+      }
+
+      pending &= ~(1u << next);
+      irqTick = tick;
+      inIrq = true;
+      handlers[next]();
+      inIrq = false;
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Index of a channel, channel-1.
+///
+/// \param     [in] DMA_Channel_TypeDef *channel
+///
+/// \return    uint8_t
+static uint8_t channel_index( const DMA_Channel_TypeDef *channel )
+{
+   return (uint8_t)(channel - Stub_DMA1_Channel);
+}
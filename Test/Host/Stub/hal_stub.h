@@ -0,0 +1,86 @@
+// ****************************************************************************
+/// \file      hal_stub.h
+///
+/// \brief     Host Stub HAL Simulation C HeaderFile
+///
+/// \details   Access of the host tests to the simulated TIM2 and DMA1. Every
+///            channel configuration taken over by the enable bit and every
+///            gpio write of a dma request is recorded with the timer tick.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+///
+/// \copyright Copyright (c) 2026 Nico Korn
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __HAL_STUB_H
+#define __HAL_STUB_H
+
+// Include ********************************************************************
+#include "stm32f1xx_hal.h"
+
+// Exported types *************************************************************
+/* gpio write of a dma request */
+typedef struct
+{
+   uint32_t    tick;       // timer tick of the request
+   uint8_t     channel;    // dma channel 1..7
+   uint16_t    value;      // written to GPIOA->ODR
+} Stub_WriteTypeDef;
+
+/* channel configuration taken over when the channel is enabled */
+typedef struct
+{
+   uint32_t    tick;
+   uint8_t     channel;    // dma channel 1..7
+   uint32_t    ccr;
+   uint32_t    cndtr;      // transfer count
+   uint32_t    cmar;       // memory address
+   uint32_t    cpar;       // peripheral address
+} Stub_ConfigTypeDef;
+
+// Exported variables *********************************************************
+extern Stub_WriteTypeDef   *Stub_Writes;
+extern uint32_t            Stub_WriteCount;
+extern Stub_ConfigTypeDef  *Stub_Configs;
+extern uint32_t            Stub_ConfigCount;
+
+// Exported functions *********************************************************
+void              Stub_reset        ( void );
+uint32_t          Stub_getTick      ( void );
+bool              Stub_step         ( void );
+void              Stub_runTicks     ( uint32_t ticks );
+void              Stub_runIdle      ( void );
+void              Stub_fail         ( const char *message ) __attribute__((noreturn));
+#endif // __HAL_STUB_H
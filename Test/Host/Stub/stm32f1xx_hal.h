@@ -0,0 +1,291 @@
+// ****************************************************************************
+/// \file      stm32f1xx_hal.h
+///
+/// \brief     Host Stub HAL C HeaderFile
+///
+/// \details   Replaces the STM32F1 HAL and CMSIS for the host tests. The
+///            registers used by the drivers are plain structs, TIM2 and the
+///            DMA1 channels 2, 5 and 7 are simulated tick by tick by
+///            hal_stub.c, the writes to GPIOA->ODR are recorded as waveform.
+///            The drivers pass the buffer addresses as uint32_t, the host
+///            binaries are linked without pie so all static data is below
+///            4 GB.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+///
+/// \copyright Copyright (c) 2026 Nico Korn
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning   The sram bit-band alias doesn't exist on the host, the drivers
+///            are built with WS2812B_BITBAND 0.
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+
+// Include ********************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Exported defines ***********************************************************
+/* core */
+#define __IO                          volatile
+#define __ALIGNED(x)                  __attribute__((aligned(x)))
+#define __disable_irq()               Stub_disableIrq()
+#define __enable_irq()                Stub_enableIrq()
+#define __WFI()                       Stub_wfi()
+#define __NOP()                       Stub_nop()
+#define __DMB()                       __sync_synchronize()
+#define assert_param(expr)            ( (expr) ? (void)0u : Stub_assert( __FILE__, __LINE__ ) )
+
+/* peripherals */
+#define TIM2                          ( &Stub_TIM2 )
+#define GPIOA                         ( &Stub_GPIOA )
+#define DMA1                          ( &Stub_DMA1 )
+#define DMA1_Channel2                 ( &Stub_DMA1_Channel[1] )
+#define DMA1_Channel5                 ( &Stub_DMA1_Channel[4] )
+#define DMA1_Channel7                 ( &Stub_DMA1_Channel[6] )
+
+/* rcc, the clocks of the peripherals are always on */
+#define __HAL_RCC_TIM2_CLK_ENABLE()   do { } while( 0 )
+#define __HAL_RCC_DMA1_CLK_ENABLE()   do { } while( 0 )
+#define __HAL_RCC_GPIOA_CLK_ENABLE()  do { } while( 0 )
+
+/* nvic */
+#define DMA1_Channel2_IRQn            ( 12 )
+#define DMA1_Channel5_IRQn            ( 15 )
+#define DMA1_Channel7_IRQn            ( 17 )
+
+/* tim */
+#define TIM_CR1_CEN                   ( 0x0001u )
+#define TIM_DIER_UDE                  ( 0x0100u )
+#define TIM_DIER_CC1DE                ( 0x0200u )
+#define TIM_DIER_CC2DE                ( 0x0400u )
+#define TIM_EGR_UG                    ( 0x0001u )
+#define TIM_DMA_UPDATE                TIM_DIER_UDE
+#define TIM_DMA_CC1                   TIM_DIER_CC1DE
+#define TIM_DMA_CC2                   TIM_DIER_CC2DE
+#define TIM_CHANNEL_1                 ( 0x0000u )
+#define TIM_CHANNEL_2                 ( 0x0004u )
+#define TIM_CCx_ENABLE                ( 0x0001u )
+#define TIM_CCx_DISABLE               ( 0x0000u )
+#define TIM_OCMODE_TIMING             ( 0x0000u )
+#define TIM_OCPOLARITY_HIGH           ( 0x0000u )
+#define TIM_COUNTERMODE_UP            ( 0x0000u )
+
+#define __HAL_TIM_SET_PRESCALER(h, v) ( (h)->Instance->PSC = (v) )
+#define __HAL_TIM_SET_COUNTER(h, v)   ( (h)->Instance->CNT = (v) )
+#define __HAL_TIM_ENABLE(h)           ( (h)->Instance->CR1 |= TIM_CR1_CEN )
+#define __HAL_TIM_DISABLE(h)          ( (h)->Instance->CR1 &= ~TIM_CR1_CEN )
+#define __HAL_TIM_ENABLE_DMA(h, d)    ( (h)->Instance->DIER |= (d) )
+#define __HAL_TIM_DISABLE_DMA(h, d)   ( (h)->Instance->DIER &= ~(d) )
+
+/* dma */
+#define DMA_CCR_EN                    ( 0x0001u )
+#define DMA_CCR_TCIE                  ( 0x0002u )
+#define DMA_CCR_HTIE                  ( 0x0004u )
+#define DMA_CCR_TEIE                  ( 0x0008u )
+#define DMA_CCR_DIR                   ( 0x0010u )
+#define DMA_CCR_CIRC                  ( 0x0020u )
+#define DMA_CCR_PINC                  ( 0x0040u )
+#define DMA_CCR_MINC                  ( 0x0080u )
+#define DMA_ISR_GIF1                  ( 0x0001u )
+#define DMA_ISR_TCIF1                 ( 0x0002u )
+#define DMA_ISR_HTIF1                 ( 0x0004u )
+#define DMA_ISR_TEIF1                 ( 0x0008u )
+#define DMA_IT_TC                     DMA_CCR_TCIE
+#define DMA_IT_HT                     DMA_CCR_HTIE
+#define DMA_IT_TE                     DMA_CCR_TEIE
+#define DMA_MEMORY_TO_PERIPH          DMA_CCR_DIR
+#define DMA_PERIPH_TO_MEMORY          ( 0x0000u )
+#define DMA_PINC_DISABLE              ( 0x0000u )
+#define DMA_MINC_ENABLE               DMA_CCR_MINC
+#define DMA_MINC_DISABLE              ( 0x0000u )
+#define DMA_NORMAL                    ( 0x0000u )
+#define DMA_CIRCULAR                  DMA_CCR_CIRC
+#define DMA_PDATAALIGN_HALFWORD       ( 0x0100u )
+#define DMA_MDATAALIGN_HALFWORD       ( 0x0400u )
+#define DMA_PRIORITY_HIGH             ( 0x2000u )
+#define DMA_FLAG_GL2                  ( DMA_ISR_GIF1 << 4u )
+#define DMA_FLAG_TC2                  ( DMA_ISR_TCIF1 << 4u )
+#define DMA_FLAG_HT2                  ( DMA_ISR_HTIF1 << 4u )
+#define DMA_FLAG_TE2                  ( DMA_ISR_TEIF1 << 4u )
+#define DMA_FLAG_GL5                  ( DMA_ISR_GIF1 << 16u )
+#define DMA_FLAG_TC5                  ( DMA_ISR_TCIF1 << 16u )
+#define DMA_FLAG_HT5                  ( DMA_ISR_HTIF1 << 16u )
+#define DMA_FLAG_TE5                  ( DMA_ISR_TEIF1 << 16u )
+#define DMA_FLAG_GL7                  ( DMA_ISR_GIF1 << 24u )
+#define DMA_FLAG_TC7                  ( DMA_ISR_TCIF1 << 24u )
+#define DMA_FLAG_HT7                  ( DMA_ISR_HTIF1 << 24u )
+#define DMA_FLAG_TE7                  ( DMA_ISR_TEIF1 << 24u )
+
+#define __HAL_DMA_ENABLE(h)           Stub_dmaEnable( (h)->Instance )
+#define __HAL_DMA_DISABLE(h)          ( (h)->Instance->CCR &= ~DMA_CCR_EN )
+#define __HAL_DMA_ENABLE_IT(h, i)     ( (h)->Instance->CCR |= (i) )
+#define __HAL_DMA_DISABLE_IT(h, i)    ( (h)->Instance->CCR &= ~(i) )
+#define __HAL_DMA_CLEAR_FLAG(h, f)    ( (h)->DmaBaseAddress->IFCR = (f) )
+
+/* gpio */
+#define GPIO_PIN_All                  ( 0xFFFFu )
+#define GPIO_MODE_OUTPUT_PP           ( 0x0001u )
+#define GPIO_SPEED_FREQ_HIGH          ( 0x0003u )
+#define GPIO_NOPULL                   ( 0x0000u )
+
+// Exported types *************************************************************
+typedef enum
+{
+   HAL_OK       = 0x00U,
+   HAL_ERROR    = 0x01U,
+   HAL_BUSY     = 0x02U,
+   HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef int IRQn_Type;
+
+typedef struct
+{
+   __IO uint32_t CR1;
+   __IO uint32_t DIER;
+   __IO uint32_t SR;
+   __IO uint32_t EGR;
+   __IO uint32_t CCER;
+   __IO uint32_t CNT;
+   __IO uint32_t PSC;
+   __IO uint32_t ARR;
+   __IO uint32_t CCR1;
+   __IO uint32_t CCR2;
+} TIM_TypeDef;
+
+typedef struct
+{
+   __IO uint32_t CCR;
+   __IO uint32_t CNDTR;
+   __IO uint32_t CPAR;
+   __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+   __IO uint32_t ISR;
+   __IO uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+   __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+   uint32_t Prescaler;
+   uint32_t CounterMode;
+   uint32_t Period;
+   uint32_t ClockDivision;
+} TIM_Base_InitTypeDef;
+
+typedef struct
+{
+   TIM_TypeDef          *Instance;
+   TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+typedef struct
+{
+   uint32_t OCMode;
+   uint32_t Pulse;
+   uint32_t OCPolarity;
+} TIM_OC_InitTypeDef;
+
+typedef struct
+{
+   uint32_t Direction;
+   uint32_t PeriphInc;
+   uint32_t MemInc;
+   uint32_t PeriphDataAlignment;
+   uint32_t MemDataAlignment;
+   uint32_t Mode;
+   uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef enum
+{
+   HAL_DMA_XFER_CPLT_CB_ID     = 0x00U,
+   HAL_DMA_XFER_HALFCPLT_CB_ID = 0x01U,
+   HAL_DMA_XFER_ERROR_CB_ID    = 0x02U
+} HAL_DMA_CallbackIDTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+   DMA_Channel_TypeDef  *Instance;
+   DMA_InitTypeDef      Init;
+   void                 (*XferCpltCallback)( struct __DMA_HandleTypeDef *hdma );
+   void                 (*XferHalfCpltCallback)( struct __DMA_HandleTypeDef *hdma );
+   void                 (*XferErrorCallback)( struct __DMA_HandleTypeDef *hdma );
+   DMA_TypeDef          *DmaBaseAddress;
+   uint32_t             ChannelIndex;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+   uint32_t Pin;
+   uint32_t Mode;
+   uint32_t Pull;
+   uint32_t Speed;
+} GPIO_InitTypeDef;
+
+// Exported variables *********************************************************
+extern uint32_t            SystemCoreClock;
+extern TIM_TypeDef         Stub_TIM2;
+extern GPIO_TypeDef        Stub_GPIOA;
+extern DMA_TypeDef         Stub_DMA1;
+extern DMA_Channel_TypeDef Stub_DMA1_Channel[7];
+
+// Exported functions *********************************************************
+HAL_StatusTypeDef HAL_TIM_Base_Init          ( TIM_HandleTypeDef *htim );
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel   ( TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel );
+void              TIM_CCxChannelCmd          ( TIM_TypeDef *TIMx, uint32_t Channel, uint32_t ChannelState );
+HAL_StatusTypeDef HAL_DMA_Init               ( DMA_HandleTypeDef *hdma );
+HAL_StatusTypeDef HAL_DMA_RegisterCallback   ( DMA_HandleTypeDef *hdma, HAL_DMA_CallbackIDTypeDef CallbackID, void (*pCallback)( DMA_HandleTypeDef *_hdma ) );
+void              HAL_DMA_IRQHandler         ( DMA_HandleTypeDef *hdma );
+void              HAL_NVIC_SetPriority       ( IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority );
+void              HAL_NVIC_EnableIRQ         ( IRQn_Type IRQn );
+void              HAL_NVIC_ClearPendingIRQ   ( IRQn_Type IRQn );
+void              HAL_GPIO_Init              ( GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init );
+
+void              Stub_disableIrq            ( void );
+void              Stub_enableIrq             ( void );
+void              Stub_wfi                   ( void );
+void              Stub_nop                   ( void );
+void              Stub_assert                ( const char *file, int line );
+void              Stub_dmaEnable             ( DMA_Channel_TypeDef *channel );
+#endif // __STM32F1xx_HAL_H
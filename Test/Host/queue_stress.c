@@ -0,0 +1,145 @@
+// ****************************************************************************
+/// \file      queue_stress.c
+///
+/// \brief     Queue Host Stress Test C Source File
+///
+/// \details   Runs the single producer single consumer queue with the
+///            producer and the consumer in two threads of the host. The
+///            producer enqueues a counting sequence, the consumer must
+///            dequeue every item once and in order. __DMB is a full memory
+///            barrier in the stub hal, so the test also checks the order of
+///            the index and the array accesses on a multi core host.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+///
+/// \copyright Copyright (c) 2026 Nico Korn
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       On the target the producer is the button interrupt and the
+///            consumer the main loop.
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "queue.h"
+#include "hal_stub.h"
+
+// Private define *************************************************************
+#define STRESS_ITEMS            ( 2000000u )   // items passed from the producer to the consumer
+#define STRESS_SIZE             ( 16u )        // small, the queue runs full and empty often
+
+// Private variables **********************************************************
+QUEUE_DEFINE( queue, STRESS_SIZE );
+
+// Private function prototypes ************************************************
+static void             *producer               ( void *arg );
+
+// Functions ******************************************************************
+// ----------------------------------------------------------------------------
+/// \brief     Runs the self test of the queue and the consumer, the process
+///            fails on the first error.
+///
+/// \param     none
+///
+/// \return    int
+int main( void )
+{
+   pthread_t   thread;
+   uint32_t    count = 0u;
+   uint8_t     item;
+   
+   if( Queue_test() != QUEUE_OK )
+   {
+      Stub_fail( "queue self test" );
+   }
+   
+   if( pthread_create( &thread, NULL, producer, NULL ) != 0 )
+   {
+      Stub_fail( "producer thread" );
+   }
+   
+   while( count < STRESS_ITEMS )
+   {
+      if( Queue_dequeue( &queue, &item ) != QUEUE_OK )
+      {
+         sched_yield();
+         continue;
+      }
+      
+      if( item != (uint8_t)count )
+      {
+         Stub_fail( "item lost, duplicated or out of order" );
+      }
+      count++;
+   }
+   
+   pthread_join( thread, NULL );
+   
+   if( !Queue_isEmpty( &queue ) )
+   {
+      Stub_fail( "queue not empty after the last item" );
+   }
+   
+   printf( "queue: %u items through a queue of %u, OK\n", (unsigned)count, (unsigned)STRESS_SIZE );
+   
+   return EXIT_SUCCESS;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Producer thread, enqueues the counting sequence and retries
+///            while the queue is full.
+///
+/// \param     [in] void *arg, unused
+///
+/// \return    void* NULL
+static void *producer( void *arg )
+{
+   uint32_t count = 0u;
+   
+   (void)arg;
+   
+   while( count < STRESS_ITEMS )
+   {
+      if( Queue_enqueue( &queue, (uint8_t)count ) == QUEUE_OK )
+      {
+         count++;
+      }
+      else
+      {
+         sched_yield();
+      }
+   }
+   
+   return NULL;
+}
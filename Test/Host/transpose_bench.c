@@ -0,0 +1,164 @@
+// ****************************************************************************
+/// \file      transpose_bench.c
+///
+/// \brief     WS2812B Host Encoder Benchmark C Source File
+///
+/// \details   Measures the bit transpose column encoder against the shift
+///            and mask reference encoder on the host. Both encode the same
+///            random frame, their bit slots must be equal. The times are
+///            those of the host cpu, on the cortex-m3 WS2812B_test records
+///            the cycles of both encoders in the CYCLES_COLUMN_SHIFTMASK and
+///            CYCLES_COLUMN_TRANSPOSE stages of the cycles module.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+///
+/// \copyright Copyright (c) 2026 Nico Korn
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       Built into the driver translation unit with the options of a
+///            variant of the Makefile.
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal_stub.h"
+// the encoders are private to the driver, the benchmark is built into its translation unit
+#include "ws2812b.c"
+
+// Private define *************************************************************
+#define BENCH_FRAMES            ( 20000u )  // encoded frames per measurement
+
+// Private variables **********************************************************
+static uint16_t         slotsShiftmask[COL*PIXEL_SLOTS];
+static uint16_t         slotsTranspose[COL*PIXEL_SLOTS];
+static uint32_t         seed = 0x2545F491u;                      // xorshift state
+
+// Private function prototypes ************************************************
+static double           bench_encoder           ( void (*encoder)( uint16_t *slots, const uint8_t *pixel, uint16_t stride ), uint16_t *slots );
+static uint64_t         now_ns                  ( void );
+static uint32_t         next_random             ( void );
+
+// Functions ******************************************************************
+// ----------------------------------------------------------------------------
+/// \brief     Compares the column encoders on a random frame and measures
+///            both over the whole frame.
+///
+/// \param     none
+///
+/// \return    int
+int main( void )
+{
+   double shiftmask;
+   double transpose;
+   
+   if( WS2812B_init() != WS2812B_READY )
+   {
+      Stub_fail( "init" );
+   }
+   
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t byte = 0; byte < FRAME_BYTES; byte++ )
+      {
+         WS2812_Frame[row][byte] = (WS2812_Color_t)next_random();
+      }
+   }
+   
+   shiftmask = bench_encoder( encode_column_shiftmask, slotsShiftmask );
+   transpose = bench_encoder( encode_column_transpose, slotsTranspose );
+   
+   if( memcmp( slotsShiftmask, slotsTranspose, sizeof(slotsShiftmask) ) != 0 )
+   {
+      Stub_fail( "the transpose encoder differs from the shift and mask encoder" );
+   }
+   
+   printf( "transpose: %u stripes of %u leds, %u bytes, per frame shiftmask %.1f us, transpose %.1f us, x%.1f\n",
+           (unsigned)ROW, (unsigned)COL, (unsigned)WS2812B_LED_BYTES, shiftmask, transpose, shiftmask/transpose );
+   
+   return EXIT_SUCCESS;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Encodes all columns of the frame BENCH_FRAMES times.
+///
+/// \param     [in]  column encoder
+/// \param     [out] bit slots of the frame
+///
+/// \return    double mean time per frame in us
+static double bench_encoder( void (*encoder)( uint16_t *slots, const uint8_t *pixel, uint16_t stride ), uint16_t *slots )
+{
+   uint64_t start = now_ns();
+   
+   for( uint32_t n = 0; n < BENCH_FRAMES; n++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         encoder( &slots[col*PIXEL_SLOTS], &WS2812_Frame[0][col*WS2812B_LED_BYTES], FRAME_BYTES );
+      }
+      // the slots are read, the encoding can't be dropped by the optimizer
+      __asm__ volatile( "" : : "r"(slots) : "memory" );
+   }
+   
+   return (double)(now_ns() - start)/BENCH_FRAMES/1000.0;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Monotonic time.
+///
+/// \param     none
+///
+/// \return    uint64_t ns
+static uint64_t now_ns( void )
+{
+   struct timespec t;
+   
+   clock_gettime( CLOCK_MONOTONIC, &t );
+   
+   return (uint64_t)t.tv_sec*1000000000u + (uint64_t)t.tv_nsec;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Pseudo random numbers, xorshift32.
+///
+/// \param     none
+///
+/// \return    uint32_t
+static uint32_t next_random( void )
+{
+   seed ^= seed << 13;
+   seed ^= seed >> 17;
+   seed ^= seed << 5;
+
+   return seed;
+}
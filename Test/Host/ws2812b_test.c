@@ -0,0 +1,953 @@
+// ****************************************************************************
+/// \file      ws2812b_test.c
+///
+/// \brief     WS2812B Host Test C Source File
+///
+/// \details   Runs the ws2812b driver against the stub hal and decodes what
+///            reaches the leds. The test draws frames through the public
+///            api and keeps its own model of the frame. Every sent frame is
+///            clocked out by the simulated TIM2 and dma channels, and the
+///            gpio writes of each stripe are decoded like a led chain does:
+///            the high time of every pulse must match a 0 or a 1 bit of the
+///            chip, the pulses must follow the bit period, the bit count
+///            must be the transmitted length and the line must stay low for
+///            the reset period before the frame is reported as latched. The
+///            decoded bytes are shifted into a model of the led chain, which
+///            must show the gamma corrected model frame after every frame.
+///
+/// \author    Nico Korn
+///
+/// \version   1.0.0.0
+///
+/// \date      16102026
+///
+/// \copyright Copyright (c) 2026 Nico Korn
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all
+/// copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+/// SOFTWARE.
+///
+/// \pre       The driver options are set by the Makefile, one binary per
+///            variant. WS2812B_DITHER changes the colors from frame to frame,
+///            its variant only checks the first frame and the average of the
+///            dithered frames.
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ws2812b.h"
+#include "hal_stub.h"
+
+// Private define *************************************************************
+/* datasheet timing in ns, centre of the high time windows with a tolerance of +-150 ns */
+#if( WS2812B_CHIP == WS2812B_CHIP_WS2812B ) || ( WS2812B_CHIP == WS2812B_CHIP_WS2813 )
+#define CHIP_T0H_NS             ( 375.0 )
+#define CHIP_T1H_NS             ( 875.0 )
+#define CHIP_PERIOD_NS          ( 1250.0 )
+#elif( WS2812B_CHIP == WS2812B_CHIP_WS2811 )
+#define CHIP_T0H_NS             ( 500.0 )
+#define CHIP_T1H_NS             ( 1200.0 )
+#define CHIP_PERIOD_NS          ( 2500.0 )
+#elif( WS2812B_CHIP == WS2812B_CHIP_SK6812 )
+#define CHIP_T0H_NS             ( 300.0 )
+#define CHIP_T1H_NS             ( 600.0 )
+#define CHIP_PERIOD_NS          ( 1250.0 )
+#endif
+#if( WS2812B_CHIP == WS2812B_CHIP_WS2813 )
+#define CHIP_RESET_NS           ( 280000.0 )
+#elif( WS2812B_CHIP == WS2812B_CHIP_SK6812 )
+#define CHIP_RESET_NS           ( 80000.0 )
+#else
+#define CHIP_RESET_NS           ( 50000.0 )
+#endif
+#define CHIP_TOLERANCE_NS       ( 150.0 )
+
+#define PIXEL_SLOTS             ( WS2812B_LED_BYTES*8u )
+#define STREAM_SLOTS            ( 2u*WS2812B_STREAM_PIXELS*PIXEL_SLOTS )
+#define FRAMES_MAX              ( 8u )      // frames sent in one check
+#define RANDOM_FRAMES           ( 300u )
+#define DITHER_FRAMES           ( 256u )    // frames averaged per dithered color
+#define DITHER_TOLERANCE        ( 0.03 )    // deviation of the driver's 8.8 fixed point correction from the exact curve
+
+#define CHECK( cond, message )  do { if( !(cond) ) { Stub_fail( message ); } } while( 0 )
+
+// Private types     **********************************************************
+/* chain as expected after a frame has latched */
+typedef struct
+{
+   uint16_t    length;                             // transmitted pixels
+   uint8_t     wire[ROW][COL][WS2812B_LED_BYTES];  // bytes of every led in wire order
+} Expect_t;
+
+// Private variables **********************************************************
+static const uint8_t    order[ROW][4] = WS2812B_ORDERS;
+static const uint8_t    ledBytes[ROW] = WS2812B_STRIPE_BYTES;
+static uint8_t          frame[ROW][COL][4];                      // model of the drawn frame, red, green, blue and white
+static uint8_t          leds[ROW][COL][WS2812B_LED_BYTES];       // bytes latched by the led chains
+static uint8_t          brightness = WS2812B_BRIGHTNESS;
+static uint16_t         changedBytes;                            // wire bytes up to the last pixel changed since the last send
+static bool             changed;
+static Expect_t         expects[FRAMES_MAX];
+static uint8_t          expected;
+static uint32_t         latchedTick[FRAMES_MAX];
+static uint32_t         latchedWrite[FRAMES_MAX];
+static uint8_t          latched;
+static uint32_t         decoded;
+static uint32_t         seed = 0x2545F491u;                      // xorshift state
+
+// Private function prototypes ************************************************
+static uint32_t         next_random             ( void );
+static uint8_t          gamma_curve             ( uint8_t color );
+static void             model_changed           ( uint8_t row, uint16_t col );
+static void             model_changed_all       ( void );
+static uint16_t         model_length            ( void );
+#if( WS2812B_DITHER == 1u )
+static double           dither_curve            ( uint16_t color );
+#else
+static void             model_set               ( uint8_t row, uint16_t col, const uint8_t *color );
+#if( WS2812B_POWER_LIMIT == 1u )
+static double           model_current           ( void );
+#endif
+static void             draw_pixel              ( uint8_t row, uint16_t col, const uint8_t *color );
+static void             draw_rect               ( uint8_t row_start, uint16_t col_start, uint8_t row_end, uint16_t col_end, const uint8_t *color );
+static void             draw_zone               ( const uint8_t *color );
+static void             draw_column             ( uint16_t col );
+static void             draw_random             ( void );
+#endif
+static void             on_latched              ( void );
+static void             send                    ( void );
+static void             begin                   ( void );
+static void             finish                  ( void );
+static void             decode_frame            ( uint8_t index, uint32_t write_start );
+static void             test_first_frame        ( void );
+#if( WS2812B_DITHER == 1u )
+static void             test_dither             ( void );
+#else
+static void             test_random_frames      ( void );
+static void             test_unchanged          ( void );
+static void             test_queue              ( void );
+static void             test_clock              ( void );
+#if( WS2812B_POWER_LIMIT == 1u )
+static void             test_power_limit        ( void );
+#endif
+#endif
+
+// Functions ******************************************************************
+// ----------------------------------------------------------------------------
+/// \brief     Runs the checks, the process fails on the first error.
+///
+/// \param     none
+///
+/// \return    int
+int main( void )
+{
+   printf( "ws2812b: %u stripes of %u leds, %u bytes, double buffer %u, streaming %u, prefix %u\n",
+           (unsigned)ROW, (unsigned)COL, (unsigned)WS2812B_LED_BYTES, (unsigned)WS2812B_DOUBLE_BUFFER,
+           (unsigned)WS2812B_STREAMING, (unsigned)WS2812B_PREFIX );
+
+   CHECK( (uintptr_t)(uint32_t)(uintptr_t)&Stub_GPIOA.ODR == (uintptr_t)&Stub_GPIOA.ODR, "the static data must be below 4 GB, link without pie" );
+   CHECK( WS2812B_init() == WS2812B_READY, "init" );
+   model_changed_all();   // init marks the whole frame
+   CHECK( WS2812B_test() == WS2812B_OK, "encoder self test" );
+
+   test_first_frame();
+#if( WS2812B_DITHER == 1u )
+   test_dither();
+#else
+   test_random_frames();
+   test_unchanged();
+   test_queue();
+   test_clock();
+#if( WS2812B_POWER_LIMIT == 1u )
+   test_power_limit();
+#endif
+#endif
+
+   printf( "ws2812b: %u frames decoded, OK\n", (unsigned)decoded );
+
+   return EXIT_SUCCESS;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     The first frame after init is the whole black chain.
+///
+/// \param     none
+///
+/// \return    none
+static void test_first_frame( void )
+{
+   begin();
+   send();
+   finish();
+}
+
+#if( WS2812B_DITHER == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     16 bit colors at a reduced brightness, sent again and again
+///            without drawing. Every frame is sent, each wire byte is one of
+///            the two 8 bit values around the corrected color and the
+///            average over the frames is the corrected color. The first
+///            leds get colors of the whole range, the others dark ones, so
+///            the power limit doesn't dim the frame.
+///
+/// \param     none
+///
+/// \return    none
+static void test_dither( void )
+{
+   static uint16_t   colors[ROW][COL][4];
+   static uint32_t   sums[ROW][COL][WS2812B_LED_BYTES];
+   double            worst = 0.0;
+
+   brightness = 200u;
+   WS2812B_setBrightness( brightness );
+
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         for( uint8_t i = 0; i < 3u; i++ )
+         {
+            colors[row][col][i] = (uint16_t)(next_random() & ( col < 4u ? 0xFFFFu : 0x1FFFu ));
+         }
+         WS2812B_setPixel16( row, col, colors[row][col][0], colors[row][col][1], colors[row][col][2] );
+      }
+   }
+
+   for( uint16_t i = 0; i < DITHER_FRAMES; i++ )
+   {
+      begin();
+      CHECK( WS2812B_sendBufferAsync( on_latched ) == WS2812B_OK, "a dithered frame isn't sent" );
+      Stub_runIdle();
+      CHECK( latched == 1u, "dithered frame not latched" );
+
+      // the whole chain is sent on every frame
+      expected = 1u;
+      expects[0].length = COL;
+      decode_frame( 0u, 0u );
+
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         for( uint16_t col = 0; col < COL; col++ )
+         {
+            for( uint8_t byte = 0; byte < ledBytes[row]; byte++ )
+            {
+               double target = dither_curve( colors[row][col][order[row][byte]] );
+
+               CHECK( leds[row][col][byte] >= (uint32_t)(target - DITHER_TOLERANCE) && leds[row][col][byte] <= (uint32_t)(target + DITHER_TOLERANCE) + 1u,
+                      "a dithered byte isn't next to the corrected color" );
+               sums[row][col][byte] += leds[row][col][byte];
+            }
+         }
+      }
+   }
+
+   // the quantization error of each frame is carried into the next one
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         for( uint8_t byte = 0; byte < ledBytes[row]; byte++ )
+         {
+            double error = (double)sums[row][col][byte]/DITHER_FRAMES - dither_curve( colors[row][col][order[row][byte]] );
+
+            error = ( error < 0.0 ) ? -error : error;
+            worst = ( error > worst ) ? error : worst;
+         }
+      }
+   }
+   printf( "ws2812b: dithered average off by %.4f at most\n", worst );
+   CHECK( worst < DITHER_TOLERANCE + 1.0/DITHER_FRAMES, "the average of the dithered frames isn't the corrected color" );
+}
+#else
+// ----------------------------------------------------------------------------
+/// \brief     Frames of random pixels, rectangles, zones and columns, each
+///            one sent on its own. The brightness changes now and then.
+///
+/// \param     none
+///
+/// \return    none
+static void test_random_frames( void )
+{
+   for( uint16_t i = 0; i < RANDOM_FRAMES; i++ )
+   {
+      begin();
+
+      if( i % 37u == 36u )
+      {
+         brightness = (uint8_t)(64u + next_random()%192u);
+         WS2812B_setBrightness( brightness );
+         model_changed_all();
+      }
+
+      for( uint8_t op = (uint8_t)(1u + next_random()%4u); op > 0u; op-- )
+      {
+         draw_random();
+      }
+
+      send();
+      finish();
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Nothing is sent when no pixel has changed, also when the same
+///            colors are drawn again.
+///
+/// \param     none
+///
+/// \return    none
+static void test_unchanged( void )
+{
+   uint8_t color[4];
+
+   begin();
+   memcpy( color, frame[0][COL/2u], sizeof(color) );
+   draw_pixel( 0u, COL/2u, color );
+   CHECK( WS2812B_sendBufferAsync( on_latched ) == WS2812B_READY, "an unchanged frame is sent" );
+   Stub_runIdle();
+   CHECK( Stub_WriteCount == 0u && latched == 0u, "an unchanged frame reaches the wire" );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Three frames drawn and sent while the previous one is on the
+///            wire. In double buffer mode the second one is queued and
+///            swapped in by the transfer complete interrupt, the third one
+///            waits for the swap.
+///
+/// \param     none
+///
+/// \return    none
+static void test_queue( void )
+{
+   const uint8_t red[4]    = { 40u, 0u, 0u, 7u };
+   const uint8_t green[4]  = { 0u, 40u, 0u, 0u };
+   const uint8_t blue[4]   = { 0u, 0u, 40u, 3u };
+
+   begin();
+
+   draw_rect( 0u, 0u, ROW-1u, COL-1u, red );
+   send();
+   Stub_runTicks( 1000u );
+   CHECK( WS2812B_getState() == WS2812B_BUSY, "the first frame isn't on the wire" );
+
+   draw_pixel( ROW-1u, 2u, green );
+   send();
+
+   draw_rect( 0u, COL/2u, 0u, COL-1u, blue );
+   draw_pixel( ROW-1u, 1u, blue );
+   send();
+
+   finish();
+
+#if( WS2812B_DOUBLE_BUFFER == 1u ) && ( WS2812B_STREAMING == 0u )
+   // the frames are encoded into both buffers in turn
+   CHECK( Stub_Configs[1].cmar != Stub_Configs[4].cmar && Stub_Configs[1].cmar == Stub_Configs[7].cmar, "the buffers aren't swapped" );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     The bit timing stays the same when the system clock changes,
+///            a clock which isn't a multiple of the timer clock is refused
+///            and so is a change while a frame is on the wire.
+///
+/// \param     none
+///
+/// \return    none
+static void test_clock( void )
+{
+   const uint8_t white[4] = { 30u, 30u, 30u, 30u };
+
+   SystemCoreClock = 24000000u;
+   CHECK( WS2812B_updateClock() == WS2812B_OK, "24 MHz refused" );
+   CHECK( Stub_TIM2.PSC == 0u, "prescaler at 24 MHz" );
+
+   begin();
+   draw_rect( 0u, 0u, 0u, 4u, white );
+   send();
+   CHECK( WS2812B_updateClock() == WS2812B_BUSY, "clock change while a frame is on the wire" );
+   finish();
+
+   SystemCoreClock = 36000000u;
+   CHECK( WS2812B_updateClock() == WS2812B_ERROR, "36 MHz accepted" );
+
+   SystemCoreClock = 72000000u;
+   CHECK( WS2812B_updateClock() == WS2812B_OK, "72 MHz refused" );
+}
+
+#if( WS2812B_POWER_LIMIT == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     A white frame above the budget is sent darker, all leds with
+///            the same color and the estimate within the budget.
+///
+/// \param     none
+///
+/// \return    none
+static void test_power_limit( void )
+{
+   Stub_reset();
+   latched = 0u;
+
+   WS2812B_fillAll( 255u, 255u, 255u );
+#if( WS2812B_LED_BYTES == 4u )
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         WS2812B_setPixelRGBW( row, col, 255u, 255u, 255u, 255u );
+      }
+   }
+#endif
+   CHECK( WS2812B_sendBufferAsync( on_latched ) == WS2812B_OK, "white frame" );
+   Stub_runIdle();
+   CHECK( latched == 1u, "white frame not latched" );
+
+   // decode against a chain of one color, which is taken from the first led
+   expected = 1u;
+   expects[0].length = COL;
+   decode_frame( 0u, 0u );
+
+   uint8_t level = leds[0][0][0];
+   CHECK( level < 255u, "the white frame isn't dimmed" );
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         for( uint8_t byte = 0; byte < ledBytes[row]; byte++ )
+         {
+            CHECK( leds[row][col][byte] == level, "the dimmed white frame isn't uniform" );
+         }
+      }
+   }
+   CHECK( WS2812B_getCurrent() <= WS2812B_POWER_BUDGET_MA, "the dimmed frame exceeds the budget" );
+}
+#endif
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Starts a check, clears the records of the stub.
+///
+/// \param     none
+///
+/// \return    none
+static void begin( void )
+{
+   Stub_reset();
+   expected = 0u;
+   latched  = 0u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs the transfers to the end and decodes every latched frame.
+///
+/// \param     none
+///
+/// \return    none
+static void finish( void )
+{
+   Stub_runIdle();
+
+   CHECK( WS2812B_getState() == WS2812B_READY, "not ready after the transfers" );
+   CHECK( latched == expected, "a sent frame hasn't been latched" );
+   CHECK( Stub_ConfigCount == 3u*expected, "three channels per frame" );
+
+   for( uint8_t i = 0; i < expected; i++ )
+   {
+      decode_frame( i, ( i == 0u ) ? 0u : latchedWrite[i-1u] );
+
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         for( uint16_t col = 0; col < COL; col++ )
+         {
+            if( memcmp( leds[row][col], expects[i].wire[row][col], ledBytes[row] ) != 0 )
+            {
+               fprintf( stderr, "frame %u, stripe %u, led %u: %02x %02x %02x, expected %02x %02x %02x\n", (unsigned)i, (unsigned)row, (unsigned)col,
+                        leds[row][col][0], leds[row][col][1], leds[row][col][2],
+                        expects[i].wire[row][col][0], expects[i].wire[row][col][1], expects[i].wire[row][col][2] );
+               Stub_fail( "the led chain doesn't show the frame" );
+            }
+         }
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends the drawn frame and records the chain it must produce.
+///
+/// \param     none
+///
+/// \return    none
+static void send( void )
+{
+   Expect_t *expect = &expects[expected];
+
+   CHECK( expected < FRAMES_MAX, "too many frames in one check" );
+
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         for( uint8_t byte = 0; byte < ledBytes[row]; byte++ )
+         {
+            uint8_t color = frame[row][col][order[row][byte]];
+
+            expect->wire[row][col][byte] = gamma_curve( (uint8_t)((color*brightness + 127u)/255u) );
+         }
+      }
+   }
+   expect->length = ( WS2812B_PREFIX == 1u ) ? model_length() : COL;
+
+   CHECK( changed != false, "nothing to send" );
+   CHECK( WS2812B_sendBufferAsync( on_latched ) == WS2812B_OK, "frame not sent" );
+
+   expected++;
+   changed        = false;
+   changedBytes   = 0u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Send callback, records the tick and the write at which the
+///            frame has been reported as latched.
+///
+/// \param     none
+///
+/// \return    none
+static void on_latched( void )
+{
+   CHECK( latched < FRAMES_MAX, "too many frames latched" );
+
+   latchedTick[latched]  = Stub_getTick();
+   latchedWrite[latched] = Stub_WriteCount;
+   latched++;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Decodes the gpio writes of one frame into the led chains and
+///            checks the channel configurations, the bit timing, the length
+///            and the reset period.
+///
+/// \param     [in] uint8_t index, frame of the check
+/// \param     [in] uint32_t write_start, first write of the frame
+///
+/// \return    none
+static void decode_frame( uint8_t index, uint32_t write_start )
+{
+   const Stub_ConfigTypeDef *high = &Stub_Configs[index*3u];
+   const Stub_ConfigTypeDef *data = &Stub_Configs[index*3u+1u];
+   const Stub_ConfigTypeDef *low  = &Stub_Configs[index*3u+2u];
+   const double             tick_ns = (Stub_TIM2.PSC + 1u)*1e9/SystemCoreClock;
+   const uint32_t           bits = expects[index].length*PIXEL_SLOTS;
+   const uint32_t           write_end = latchedWrite[index];
+
+   // update event, cc1 and cc2 channels with the frame and the reset length
+   CHECK( high->channel == 2u && data->channel == 5u && low->channel == 7u, "channel order" );
+   CHECK( *(const uint16_t*)(uintptr_t)high->cmar == 0xFFFFu && (high->ccr & DMA_CCR_MINC) == 0u, "update event doesn't set all pins" );
+   CHECK( *(const uint16_t*)(uintptr_t)low->cmar == 0x0000u && (low->ccr & DMA_CCR_MINC) == 0u, "cc2 doesn't clear all pins" );
+   CHECK( high->cndtr == bits, "high slots don't match the frame length" );
+#if( WS2812B_STREAMING == 1u )
+   CHECK( data->cndtr == STREAM_SLOTS && (data->ccr & (DMA_CCR_MINC | DMA_CCR_CIRC)) == (DMA_CCR_MINC | DMA_CCR_CIRC), "data ring" );
+#else
+   CHECK( data->cndtr == bits && (data->ccr & (DMA_CCR_MINC | DMA_CCR_CIRC)) == DMA_CCR_MINC, "data slots don't match the frame length" );
+#endif
+   CHECK( low->cndtr > bits, "no reset slots" );
+   CHECK( (low->cndtr - bits - 1u)*CHIP_PERIOD_NS < CHIP_RESET_NS, "more reset slots than needed" );
+
+   // the timer ticks of the chip timing
+   CHECK( (Stub_TIM2.ARR + 1u)*tick_ns > CHIP_PERIOD_NS - CHIP_TOLERANCE_NS && (Stub_TIM2.ARR + 1u)*tick_ns < CHIP_PERIOD_NS + CHIP_TOLERANCE_NS, "bit period" );
+
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      const uint16_t pin      = (uint16_t)(1u << row);
+      bool           level    = false;
+      uint32_t       rise     = 0u;
+      uint32_t       fall     = Stub_Writes[write_start].tick;
+      uint32_t       count    = 0u;
+      uint8_t        byte     = 0u;
+
+      for( uint32_t w = write_start; w < write_end; w++ )
+      {
+         const Stub_WriteTypeDef *write = &Stub_Writes[w];
+         bool                    next  = (write->value & pin) != 0u;
+
+         if( level == false && next != false )
+         {
+            // the rising edges follow the bit period
+            CHECK( count == 0u || write->tick - rise == Stub_TIM2.ARR + 1u, "rising edges out of the bit period" );
+            CHECK( write->channel == 2u, "rising edge not on the update event" );
+            rise = write->tick;
+         }
+         else if( level != false && next == false )
+         {
+            double high_ns = (write->tick - rise)*tick_ns;
+            bool   one;
+
+            if( high_ns > CHIP_T0H_NS - CHIP_TOLERANCE_NS && high_ns < CHIP_T0H_NS + CHIP_TOLERANCE_NS )
+            {
+               one = false;
+            }
+            else if( high_ns > CHIP_T1H_NS - CHIP_TOLERANCE_NS && high_ns < CHIP_T1H_NS + CHIP_TOLERANCE_NS )
+            {
+               one = true;
+            }
+            else
+            {
+               Stub_fail( "high time is no valid bit" );
+            }
+
+            CHECK( count < bits, "more bits than the frame length" );
+            byte = (uint8_t)(byte << 1) | (uint8_t)one;
+            count++;
+            // the bytes behind the chain drop out of the last led
+            if( count % 8u == 0u && count/8u <= COL*ledBytes[row] )
+            {
+               leds[row][(count/8u-1u)/ledBytes[row]][(count/8u-1u)%ledBytes[row]] = byte;
+            }
+            fall = write->tick;
+         }
+
+         level = next;
+      }
+
+      CHECK( level == false, "line high at the end of the frame" );
+      CHECK( count == bits, "bit count doesn't match the frame length" );
+      CHECK( (count/8u) % ledBytes[row] == 0u || count/8u >= COL*ledBytes[row], "a led gets a part of its bytes" );
+      CHECK( (latchedTick[index] - fall)*tick_ns >= CHIP_RESET_NS, "latched before the reset period" );
+   }
+
+   decoded++;
+}
+
+#if( WS2812B_DITHER == 0u )
+// ----------------------------------------------------------------------------
+/// \brief     Draws one random element, the colors of the larger ones are
+///            dark and the frame is cleared before it exceeds the power
+///            budget, so the power limit doesn't dim it.
+///
+/// \param     none
+///
+/// \return    none
+static void draw_random( void )
+{
+   uint8_t color[4];
+   uint8_t row = (uint8_t)(next_random()%ROW);
+   uint16_t col = (uint16_t)(next_random()%COL);
+
+   for( uint8_t i = 0; i < 4u; i++ )
+   {
+      color[i] = (uint8_t)next_random();
+   }
+
+   switch( next_random()%5u )
+   {
+      case 0:
+      case 1:
+         draw_pixel( row, col, color );
+         break;
+      case 2:
+      {
+         uint8_t  row_end = (uint8_t)(row + next_random()%3u);
+         uint16_t col_end = (uint16_t)(col + next_random()%12u);
+
+         for( uint8_t i = 0; i < 4u; i++ )
+         {
+            color[i] &= 0x3Fu;
+         }
+         draw_rect( row, col, row_end, col_end, color );
+         break;
+      }
+      case 3:
+         for( uint8_t i = 0; i < 4u; i++ )
+         {
+            color[i] &= 0x3Fu;
+         }
+         draw_zone( color );
+         break;
+      default:
+         draw_column( col );
+         break;
+   }
+
+#if( WS2812B_POWER_LIMIT == 1u )
+   if( model_current() > WS2812B_POWER_BUDGET_MA*0.9 )
+   {
+      const uint8_t black[4] = { 0u, 0u, 0u, 0u };
+
+      draw_rect( 0u, 0u, ROW-1u, COL-1u, black );
+   }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Drawing through the driver and into the model.
+static void draw_pixel( uint8_t row, uint16_t col, const uint8_t *color )
+{
+#if( WS2812B_LED_BYTES == 4u )
+   uint8_t red, green, blue, white;
+
+   WS2812B_setPixelRGBW( row, col, color[0], color[1], color[2], color[3] );
+   CHECK( WS2812B_getPixelRGBW( row, col, &red, &green, &blue, &white ) == WS2812B_OK, "getPixelRGBW" );
+   CHECK( red == color[0] && green == color[1] && blue == color[2], "getPixelRGBW doesn't read back" );
+   CHECK( white == ( ledBytes[row] == 4u ? color[3] : 0u ), "getPixelRGBW doesn't read back the white" );
+   model_set( row, col, color );
+#else
+   const uint8_t rgb[4] = { color[0], color[1], color[2], 0u };
+   uint8_t       red, green, blue;
+
+   WS2812B_setPixel( row, col, color[0], color[1], color[2] );
+   CHECK( WS2812B_getPixel( row, col, &red, &green, &blue ) == WS2812B_OK, "getPixel" );
+   CHECK( red == color[0] && green == color[1] && blue == color[2], "getPixel doesn't read back" );
+   model_set( row, col, rgb );
+#endif
+}
+
+static void draw_rect( uint8_t row_start, uint16_t col_start, uint8_t row_end, uint16_t col_end, const uint8_t *color )
+{
+   const uint8_t rgb[4] = { color[0], color[1], color[2], 0u };
+
+   // the driver clips, so does the model
+   WS2812B_fillRect( row_start, col_start, row_end, col_end, color[0], color[1], color[2] );
+
+   for( uint8_t row = row_start; row <= row_end && row < ROW; row++ )
+   {
+      for( uint16_t col = col_start; col <= col_end && col < COL; col++ )
+      {
+         model_set( row, col, rgb );
+      }
+   }
+}
+
+static void draw_zone( const uint8_t *color )
+{
+   static const WS2812B_SpanTypeDef spans[] =
+   {
+      WS2812B_SPAN( 0u, 3u, 10u ),
+      WS2812B_SPAN_MIRROR( ROW-1u, 0u, 4u ),
+      WS2812B_PIXEL( 0u, COL-1u )
+   };
+   static const WS2812B_ZoneTypeDef zone = WS2812B_ZONE( spans );
+   const uint8_t rgb[4] = { color[0], color[1], color[2], 0u };
+
+   WS2812B_fillZone( &zone, color[0], color[1], color[2] );
+
+   for( uint16_t col = 3u; col <= 10u; col++ )
+   {
+      model_set( 0u, col, rgb );
+   }
+   for( uint16_t col = COL-5u; col < COL; col++ )
+   {
+      model_set( ROW-1u, col, rgb );
+   }
+   model_set( 0u, COL-1u, rgb );
+}
+
+static void draw_column( uint16_t col )
+{
+   uint8_t rgb[ROW*3u];
+
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint8_t i = 0; i < 3u; i++ )
+      {
+         rgb[row*3u+i] = (uint8_t)next_random();
+      }
+   }
+
+   WS2812B_setColumn( col, rgb );
+
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      const uint8_t color[4] = { rgb[row*3u], rgb[row*3u+1u], rgb[row*3u+2u], 0u };
+
+      model_set( row, col, color );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sets a pixel of the model, a changed one extends the length
+///            which must be transmitted.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col
+/// \param     [in] uint8_t *color, red, green, blue and white
+///
+/// \return    none
+static void model_set( uint8_t row, uint16_t col, const uint8_t *color )
+{
+   // a rgb stripe has no white
+   if( memcmp( frame[row][col], color, ledBytes[row] ) == 0 )
+   {
+      return;
+   }
+
+   memcpy( frame[row][col], color, ledBytes[row] );
+   model_changed( row, col );
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Extends the length which must be transmitted up to a changed
+///            pixel.
+///
+/// \param     [in] uint8_t row
+/// \param     [in] uint16_t col
+///
+/// \return    none
+static void model_changed( uint8_t row, uint16_t col )
+{
+   uint16_t end = (uint16_t)((col + 1u)*ledBytes[row]);
+
+   if( end > changedBytes )
+   {
+      changedBytes = end;
+   }
+   changed = true;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     The whole frame must be transmitted.
+///
+/// \param     none
+///
+/// \return    none
+static void model_changed_all( void )
+{
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      model_changed( row, COL-1u );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Pixel columns the driver must send with WS2812B_PREFIX: the
+///            columns of WS2812B_LED_BYTES bytes which hold the changed bytes,
+///            extended until no led within its chain gets a part of its
+///            bytes only.
+///
+/// \param     none
+///
+/// \return    uint16_t
+static uint16_t model_length( void )
+{
+   uint16_t length = (uint16_t)((changedBytes + WS2812B_LED_BYTES - 1u)/WS2812B_LED_BYTES);
+   bool     split  = true;
+
+   while( split && length < COL )
+   {
+      split = false;
+      for( uint8_t row = 0; row < ROW; row++ )
+      {
+         uint32_t bytes = length*WS2812B_LED_BYTES;
+
+         split |= bytes < COL*ledBytes[row] && bytes % ledBytes[row] != 0u;
+      }
+      length += split;
+   }
+
+   return length;
+}
+
+#if( WS2812B_POWER_LIMIT == 1u ) && ( WS2812B_DITHER == 0u )
+// ----------------------------------------------------------------------------
+/// \brief     Current of the model frame in mA with the led figures of the
+///            driver.
+///
+/// \param     none
+///
+/// \return    double
+static double model_current( void )
+{
+   double sum = 0.0;
+
+   for( uint8_t row = 0; row < ROW; row++ )
+   {
+      for( uint16_t col = 0; col < COL; col++ )
+      {
+         for( uint8_t i = 0; i < ledBytes[row]; i++ )
+         {
+            sum += gamma_curve( frame[row][col][i] );
+         }
+      }
+   }
+
+   return ROW*COL*WS2812B_IDLE_MA + sum*WS2812B_CHANNEL_MA/255.0*gamma_curve( brightness )/255.0;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Gamma curve of the driver, rounded to nearest.
+///
+/// \param     [in] uint8_t color
+///
+/// \return    uint8_t
+static uint8_t gamma_curve( uint8_t color )
+{
+   uint32_t x = color;
+
+#if( WS2812B_GAMMA == WS2812B_GAMMA_2_0 )
+   return (uint8_t)((2u*x*x + 255u)/510u);
+#elif( WS2812B_GAMMA == WS2812B_GAMMA_3_0 )
+   return (uint8_t)((2u*x*x*x + 65025u)/130050u);
+#else
+   return (uint8_t)x;
+#endif
+}
+
+#if( WS2812B_DITHER == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Gamma and brightness correction of a 16 bit color, the exact
+///            curve the driver interpolates in 8.8 fixed point.
+///
+/// \param     [in] uint16_t color
+///
+/// \return    double corrected color, 0..255
+static double dither_curve( uint16_t color )
+{
+   double x = color/65536.0*brightness/255.0;
+
+#if( WS2812B_GAMMA == WS2812B_GAMMA_2_0 )
+   return 255.0*x*x;
+#elif( WS2812B_GAMMA == WS2812B_GAMMA_3_0 )
+   return 255.0*x*x*x;
+#else
+   return 255.0*x;
+#endif
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Pseudo random numbers, xorshift32.
+///
+/// \param     none
+///
+/// \return    uint32_t
+static uint32_t next_random( void )
+{
+   seed ^= seed << 13;
+   seed ^= seed >> 17;
+   seed ^= seed << 5;
+
+   return seed;
+}